@@ -47,6 +47,9 @@ void App_Commander::setup() {
 	// preference
 	the_settings_menu.begin(appid_to_slotid(get_APP_ID()));
 
+	// the parser of the_uart_queue (for the receive stats)
+	the_uart_parser = &parse_ascii;
+
 	// init the TWE M5 support
 	setup_screen(); // initialize TWE M5 support.
 
@@ -84,6 +84,7 @@ public:
 
 	~App_Commander() {
 		APP_HNDLR::on_close();
+		if (the_uart_parser == &parse_ascii) the_uart_parser = nullptr;
 	}
 
 	void setup();
@@ -282,6 +282,9 @@ void App_FirmProg::setup() {
 	// preference
 	the_settings_menu.begin(appid_to_slotid(get_APP_ID()));
 
+	// the parser of the_uart_queue (for the receive stats)
+	the_uart_parser = &parse_ascii;
+
 	// default vars
 	if (_firmfile_dir.size() == 0) {
 		_firmfile_dir << get_dir_tweapps();
@@ -118,7 +118,9 @@ public:
 		SubScreen::_parent = this;
 	}
 
-	~App_FirmProg() {}
+	~App_FirmProg() {
+		if (the_uart_parser == &parse_ascii) the_uart_parser = nullptr;
+	}
 
 	void setup();
 
@@ -50,6 +50,9 @@ void APP_BASE::setup() {
 	// preference
 	the_settings_menu.begin(appid_to_slotid(get_APP_ID()));
 
+	// the parser of the_uart_queue (for the receive stats)
+	the_uart_parser = &parse_ascii;
+
 	// init the TWE M5 support
 	setup_screen(); // initialize TWE M5 support.
 
@@ -560,7 +563,10 @@ public:
 
 private:
 	// Serial Parser
-	AsciiParser parse_ascii;
+	AutoParserT<256> parse_ascii; // ASCII and binary frames
+
+	// copies of a packet via repeaters (the best LQI copy is shown, enabled by the settings)
+	PacketDedup _dedup;
 
 	// default color
 	uint16_t default_bg_color;
@@ -597,7 +603,8 @@ public:
 		, the_screen(app.the_screen)
 		, the_screen_b(app.the_screen_b)
 		, the_screen_c(app.the_screen_c)
-		, parse_ascii(256)
+		, parse_ascii()
+		, _dedup(256, PacketDedup::DEFAULT_WINDOW_MS, true, false)
 		, default_bg_color(0)
 		, default_fg_color(0)
 		, pkt_data(app.the_screen, app.the_screen_t)
@@ -606,7 +613,12 @@ public:
 	{
 	}
 
-	virtual ~SCR_GLANCER() {}
+	virtual ~SCR_GLANCER() {
+		if (the_uart_parser == &parse_ascii) the_uart_parser = &_base.parse_ascii;
+#if defined(MWM5_SERIAL_MULTI)
+		the_serial_multi.set_dedup(nullptr);
+#endif
+	}
 
 	void setup();
 
@@ -616,6 +628,7 @@ public:
 
 private:
 	void parse_a_byte(char_t u8b);
+	void process_packet(spTwePacket& pkt);
 	void process_input();
 	void check_for_serial();
 
@@ -632,6 +645,7 @@ void APP_BASE::hndr_SCR_GLANCER(event_type ev, arg_type arg) { hndr<SCR_GLANCER>
 void APP_BASE::SCR_GLANCER::setup() {
 	// preference
 	the_settings_menu.begin(appid_to_slotid(_base.get_APP_ID()));
+	_dedup.set_enabled(sAppData.u8_TWESTG_STAGE_DEDUP != 0);
 	
 	// put a init message
 	const char* fmt_title = MLSL(
@@ -640,6 +654,9 @@ void APP_BASE::SCR_GLANCER::setup() {
 	the_screen_t << printfmt(fmt_title, "---"); // accepts UTF-8 codes
 	pkt_data.init_screen(fmt_title);
 
+	// this screen parses the_uart_queue by its own parser.
+	the_uart_parser = &parse_ascii;
+
 	// change screen size
 	_base.screen_layout_apps();
 
@@ -652,6 +669,11 @@ void APP_BASE::SCR_GLANCER::setup() {
 
 	// button navigation
 	set_nav_bar();
+
+#if defined(MWM5_SERIAL_MULTI)
+	// drop the copies of other ports and repeaters before decoding
+	the_serial_multi.set_dedup(_dedup.is_enabled() ? &_dedup : nullptr);
+#endif
 }
 
 
@@ -793,43 +815,71 @@ void APP_BASE::SCR_GLANCER::parse_a_byte(char_t u8b) {
 	parse_ascii << u8b;
 
 	// if complete parsing
-	if (parse_ascii) {
+	if (parse_ascii && _dedup.accept(parse_ascii)) {
 		// output as parser format
 		// the_screen_b << parse_ascii;
-		if (!_b_hold_screen_b) the_screen_b.clear_screen();
-		static int ct;
-		if (!_b_hold_screen_b) the_screen_b << "PKT(" << ct++ << ')';
-
-		// EEPROM TEST
-		auto&& p = parse_ascii.get_payload();
 
 		// 1. identify the packet type
-		auto&& pkt = newTwePacket(parse_ascii.get_payload());
-		if (!_b_hold_screen_b) the_screen_b << ":Typ=" << int(identify_packet_type(pkt));
-
-		if (identify_packet_type(pkt) != E_PKT::PKT_ERROR) {
-			// put information
-			if (!_b_hold_screen_b) the_screen_b
-					<< printfmt(":Lq=%d:Ad=%08X(%02X),Tms=%d"
-						, pkt->common.lqi, pkt->common.src_addr, pkt->common.src_lid, pkt->common.tick);
-
-			// store data into `pal_data'
-			if (pkt_data.add_entry(pkt)) {
-				// update screen.
-				pkt_data.update_term(pkt, false);
-			}
+		auto&& pkt = newTwePacket(parse_ascii);
+		process_packet(pkt);
+	}
+}
+
+// handle a packet
+void APP_BASE::SCR_GLANCER::process_packet(spTwePacket& pkt) {
+	if (!_b_hold_screen_b) the_screen_b.clear_screen();
+	static int ct;
+	if (!_b_hold_screen_b) the_screen_b << "PKT(" << ct++ << ')';
+
+	if (!_b_hold_screen_b) the_screen_b << ":Typ=" << int(identify_packet_type(pkt));
+
+	if (identify_packet_type(pkt) != E_PKT::PKT_ERROR) {
+		// put information
+		if (!_b_hold_screen_b) the_screen_b
+				<< printfmt(":Lq=%d:Ad=%08X(%02X),Tms=%d"
+					, pkt->common.lqi, pkt->common.src_addr, pkt->common.src_lid, pkt->common.tick);
+		if (!_b_hold_screen_b && pkt->common.port) the_screen_b << printfmt(",Pt=%d", pkt->common.port);
+
+		// store data into `pal_data'
+		if (pkt_data.add_entry(pkt)) {
+			// update screen.
+			pkt_data.update_term(pkt, false);
 		}
 	}
 }
 
 // process input
 void APP_BASE::SCR_GLANCER::process_input() {
-	int c;
+	uint8_t buf[256];
+	int len;
+	uint32_t tick;
+
+#if defined(MWM5_SERIAL_MULTI)
+	if (the_serial_multi.count() > 0) {
+		// multiple ports: packets of Serial2 (port 0) and the other ports are merged by arrival tick.
+		while (0 < (len = the_uart_queue.read(buf, sizeof(buf), tick))) {
+			the_serial_multi.feed(0, buf, len, tick);
+		}
+
+		while (the_serial_multi.available()) {
+			auto&& pkt = the_serial_multi.pop();
+			process_packet(pkt);
+		}
+		return;
+	}
+#endif
+
+	// from TWE (read by chunk, the queue is locked once per chunk)
+	while (0 < (len = the_uart_queue.read(buf, sizeof(buf), tick))) {
+		parse_ascii.set_tick(tick); // arrival tick of the chunk
+
+		// pass them to M5 (normal packet analysis, the whole chunk at once)
+		parse_ascii.parse(buf, len, [this](AutoParser& p) {
+			if (!_dedup.accept(p)) return;
 
-	// from TWE
-	while (-1 != (c = the_uart_queue.read())) {
-		// pass them to M5 (normal packet analysis)
-		parse_a_byte(char_t(c));
+			auto&& pkt = newTwePacket(p);
+			process_packet(pkt);
+		});
 	}
 }
 
@@ -12,7 +12,7 @@ class App_Glancer : public TWE::APP_DEF, public TWE::APP_DESC<App_Glancer>, publ
 
 private:
 	// Serial Parser
-	AsciiParser parse_ascii;
+	AsciiParserT<512> parse_ascii;
 
 	// top bar
 	TWETerm_M5_Console the_screen_t; // init the screen.
@@ -56,7 +56,7 @@ private:
 public:
 	App_Glancer(int exit_id = -1)
 		: APP_DEF(int(E_APP_ID::SMPL_VIEWER))
-		, parse_ascii(512)
+		, parse_ascii()
 #if M5_SCREEN_HIRES == 0
 		, the_screen_t(64, 1, { 0, 0, 320, 18 }, M5)
 		, the_screen_tab(64, 20, { 0, 18, 320, 10 }, M5)
@@ -85,6 +85,7 @@ public:
 
 	~App_Glancer() {
 		APP_HNDLR<App_Glancer>::on_close();
+		if (the_uart_parser == &parse_ascii) the_uart_parser = nullptr;
 	}
 
 	void setup();
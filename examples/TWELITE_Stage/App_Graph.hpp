@@ -87,6 +87,7 @@ public:
 
 	~App_Graph() {
 		APP_HNDLR<App_Graph>::on_close();
+		if (the_uart_parser == &parse_ascii) the_uart_parser = nullptr;
 	}
 
 	void setup();
@@ -1478,7 +1478,15 @@ public:
 	// object references to the App_ARIA
     TWETerm_M5_Console& the_screen;
 	ITerm& the_screen_b;
-	IParser& parse_ascii;
+	AsciiParser& parse_ascii;
+
+	// completed frames from parse_ascii (decoded and stored into DB by a batch)
+	static const int FRAME_POOL_SLOTS = 128;
+	TWESERCMD::FramePool _frames;
+
+	// copies of a packet via repeaters are dropped before decoding (enabled by the settings),
+	// the better LQI copy is also dropped, not to be stored into DB twice.
+	PacketDedup _dedup;
 
 	// database
     std::unique_ptr<WSnsDb> _db;
@@ -3549,26 +3557,30 @@ public:
     }
 
     /**
-     * process UART data and put sensor data into DB.
+     * put sensor data of the packet into DB.
      * 
-     * \param u8b       a byte from UART.
+     * \param pkt       a packet (from the frame pool or SerialMulti).
      */
-	void parse_a_byte(char_t u8b) {
-		// parse.
-		parse_ascii << u8b;
-
-		// if complete parsing
-		if (parse_ascii) {
+    void process_packet(spTwePacket& pkt) {
+        {
 			// output as parser format
 			the_screen_b.clear_screen();
 			the_screen_b << "PKT(" << ++_pkt_rcv_ct << ')';
 
-			// 1. identify the packet type
-			auto&& pkt = newTwePacket(parse_ascii.get_payload());
             auto pkt_type = identify_packet_type(pkt);
 			the_screen_b << ":Typ=" << int(pkt_type);
 
             WSnsDb::SENSOR_DATA d;
+
+            // timestamp by the arrival tick of the packet (not the processing time).
+            if (pkt) {
+                TWESYS::TweLocalTime t;
+                t.now();
+
+                uint64_t ms = t.epoch * 1000 + t.ms - uint32_t(millis() - pkt->common.tick);
+                d.ts = DB_TIMESTAMP::value_type(ms / 1000);
+                d.ts_msec = DB_INTEGER::value_type(ms % 1000);
+            }
             
             if (pkt_type == E_PKT::PKT_TWELITE) {
                 auto&& atw = refTwePacketTwelite(pkt);
@@ -6224,14 +6236,54 @@ public:
         }
 	}
 
+    /**
+     * decode the frames in the pool and put them into DB (by a batch).
+     */
+    void drain_frames() {
+        TWESERCMD::FrameRef frames[16];
+        size_t n;
+
+        while (0 < (n = _frames.pop(frames, 16))) {
+            for (size_t i = 0; i < n; i++) {
+                if (!_dedup.accept(frames[i])) {
+                    frames[i].reset();
+                    continue;
+                }
+
+                auto&& pkt = newTwePacket(frames[i]);
+                frames[i].reset(); // return the slot
+                process_packet(pkt);
+            }
+        }
+    }
+
 	void loop() {
-        // read the uart queue
-        do {
-            int c = the_uart_queue.read();
+        // read the uart queue (by chunk)
+        {
+            uint8_t buf[256];
+            int len;
+            uint32_t tick;
 
-            if (c >= 0) parse_a_byte(c);
+#if defined(MWM5_SERIAL_MULTI)
+            if (the_serial_multi.count() > 0) {
+                // multiple ports: packets of Serial2 (port 0) and the other ports are merged by arrival tick.
+                while (0 < (len = the_uart_queue.read(buf, sizeof(buf), tick))) {
+                    the_serial_multi.feed(0, buf, len, tick);
+                }
+                while (the_serial_multi.available()) {
+                    auto&& pkt = the_serial_multi.pop();
+                    process_packet(pkt);
+                }
+            } else
+#endif
+            while (0 < (len = the_uart_queue.read(buf, sizeof(buf), tick))) {
+                parse_ascii.set_tick(tick); // arrival tick of the chunk
+                parse_ascii.parse(buf, len); // completed frames are stored into _frames.
 
-        } while (the_uart_queue.available());
+                // a chunk has a few frames, drain the pool before the next one (the pool never gets full)
+                drain_frames();
+            }
+        }
 
         // DB handling (commit every seconds)
         if (_is_new_sec()) {
@@ -6271,6 +6323,8 @@ public:
         , _btns(*this, app.the_screen)
         , _pkt_rcv_ct(0)
         , the_screen(app.the_screen), the_screen_b(app.the_screen_b), parse_ascii(app.parse_ascii)
+        , _frames(FRAME_POOL_SLOTS, uint16_t(app.parse_ascii.get_payload().capacity()))
+        , _dedup(256, PacketDedup::DEFAULT_WINDOW_MS, false, sAppData.u8_TWESTG_STAGE_DEDUP != 0)
         , _db(), _db_transaction()
         , _sec(0)
         , _scr_sub()
@@ -6281,7 +6335,10 @@ public:
         , _rnd()
 #endif
     {
-        ;
+        parse_ascii.set_frame_pool(&_frames);
+#if defined(MWM5_SERIAL_MULTI)
+        the_serial_multi.set_dedup(_dedup.is_enabled() ? &_dedup : nullptr);
+#endif
     }
 
     /**
@@ -6289,6 +6346,10 @@ public:
      */
     ~SCR_WSNS_DB()
     {
+        parse_ascii.set_frame_pool(nullptr);
+#if defined(MWM5_SERIAL_MULTI)
+        the_serial_multi.set_dedup(nullptr);
+#endif
         db_close();
     }
 };
@@ -23,6 +23,9 @@ const wchar_t* App_TweLite::APP_DESC<App_TweLite>::LAUNCH_MSG[] = {
 void App_TweLite::setup() {
 	// preference
 	the_settings_menu.begin(appid_to_slotid(get_APP_ID()));
+
+	// the parser of the_uart_queue (for the receive stats)
+	the_uart_parser = &parse_ascii;
 	
 	// init the TWE M5 support
 	setup_screen(); // initialize TWE M5 support.
@@ -307,7 +310,7 @@ void App_TweLite::parse_a_byte(char_t u8b) {
 		auto&& p = parse_ascii.get_payload();
 
 		// 1. identify the packet type
-		auto&& pkt = newTwePacket(parse_ascii.get_payload());
+		auto&& pkt = newTwePacket(parse_ascii);
 		the_screen_b << ":Typ=" << int(identify_packet_type(pkt));
 
 		if (identify_packet_type(pkt) == E_PKT::PKT_TWELITE) {
@@ -329,12 +332,17 @@ void App_TweLite::parse_a_byte(char_t u8b) {
 
 // process input
 void App_TweLite::process_input() {
-	int c;
+	uint8_t buf[256];
+	int len;
+	uint32_t tick;
+
+	// from TWE (read by chunk, the queue is locked once per chunk)
+	while (0 < (len = the_uart_queue.read(buf, sizeof(buf), tick))) {
+		parse_ascii.set_tick(tick); // arrival tick of the chunk
+		parse_ascii.check_timeout(tick); // timeout of a partial frame (once per chunk)
 
-	// from TWE
-	while (-1 != (c = the_uart_queue.read())) {
 		// pass them to M5 (normal packet analysis)
-		parse_a_byte(char_t(c));
+		for (int i = 0; i < len; i++) parse_a_byte(char_t(buf[i]));
 	}
 }
 
@@ -66,7 +66,9 @@ public:
 		set_appobj((void*)static_cast<ITerm*>(&the_screen)); // store app specific obj into APPDEF class storage.
 	}
 
-	~App_TweLite() {}
+	~App_TweLite() {
+		if (the_uart_parser == &parse_ascii) the_uart_parser = nullptr;
+	}
 
 	void setup();
 
@@ -272,21 +272,30 @@ void update_serial_keyb_input(bool force_update = false) {
 	}
 #else
 # ifndef ESP32
+	uint8_t buf[256];
+	int len;
+	uint32_t tick; // arrival tick of the chunk
+
 	if (force_update) { // grab actual serial data here
 		while (Serial2.update()) {
 			// UART2 : connected to TWE
-			while (Serial2.available()) {
-				int c = Serial2.read();
-				if (c >= 0) the_uart_queue.push(c);
+			while (0 < (len = Serial2.read(buf, sizeof(buf), tick))) {
+				the_uart_queue.push(buf, len, tick);
 			}
 		}
 	}
-# endif
+
+	// UART2 : connected to TWE (move by chunk, each queue is locked once per chunk)
+	while (0 < (len = Serial2.read(buf, sizeof(buf), tick))) {
+		the_uart_queue.push(buf, len, tick);
+	}
+# else
 	// UART2 : connected to TWE
 	while (Serial2.available()) {
 		int c = Serial2.read();
 		if (c >= 0) the_uart_queue.push(c);
 	}
+# endif
 #endif
 }
 
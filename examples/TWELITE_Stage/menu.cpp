@@ -30,6 +30,8 @@ void MyTweMenu::vQueryAppData() {
 			sAppData.u8_TWESTG_STAGE_APPWRT_BUILD_NEXT_SCREEN = TWESTG_ITER_tsFinal_G_U8(sp); break;
 		case E_TWESTG_STAGE_BAUD_TERM:
 			sAppData.u32_TWESTG_STAGE_BAUD_TERM = TWESTG_ITER_tsFinal_G_U32(sp); break;
+		case E_TWESTG_STAGE_DEDUP:
+			sAppData.u8_TWESTG_STAGE_DEDUP = TWESTG_ITER_tsFinal_G_U8(sp); break;
 #ifndef ESP32
 		case E_TWESTG_STAGE_APPWRT_OPEN_CODE:
 			sAppData.u8_TWESTG_STAGE_OPEN_CODE = TWESTG_ITER_tsFinal_G_U8(sp); break;
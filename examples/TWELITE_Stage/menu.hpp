@@ -13,6 +13,7 @@ struct _sAppData {
 	uint32_t u32_TWESTG_STAGE_FG_COLOR;
 	uint32_t u32_TWESTG_STAGE_BG_COLOR;
 	uint32_t u32_TWESTG_STAGE_BAUD_TERM;
+	uint8_t u8_TWESTG_STAGE_DEDUP; // if set, drop the copies of a packet relayed by repeaters.
 #ifdef ESP32
 	uint8_t u8_TWESTG_STAGE_KEYBOARD_LAYOUT;
 	uint8_t u8_TWESTG_STAGE_INTRCT_USE_SETPIN;
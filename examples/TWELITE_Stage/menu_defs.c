@@ -83,10 +83,19 @@ const TWESTG_tsElement TWESTG_STAGE_BASE[] = {
 		{ TWESTG_DATATYPE_UINT32,  sizeof(uint32),  0, 0,  {.u32 = 115200}},
 		{ "BAU", "ボーレート",
 		  "ﾀｰﾐﾅﾙ･ｲﾝﾀﾗｸﾃｨﾌﾞﾓｰﾄﾞのﾎﾞｰﾚｰﾄを指定します。\r\n"
-		  "115200bpsが標準で9600-115200で指定します。\r\n"
+		  "115200bpsが標準で9600-3000000で指定します。\r\n"
 		  "ｱﾌﾟﾘ側での対応が必要です。" },
-		{ E_TWEINPUTSTRING_DATATYPE_DEC, 6, 'B' },
-		{ {.u32 = 9600}, {.u32 = 1000000}, TWESTGS_VLD_u32MinMax, NULL },
+		{ E_TWEINPUTSTRING_DATATYPE_DEC, 7, 'B' },
+		{ {.u32 = 9600}, {.u32 = 3000000}, TWESTGS_VLD_u32MinMax, NULL },
+	},
+	{ E_TWESTG_STAGE_DEDUP,
+		{ TWESTG_DATATYPE_UINT8,  sizeof(uint8),  0, 0, {.u8 = 0 }},
+		{ "DUP", "中継パケットの重複除去",
+		  "中継機経由で複数回届いた同じパケットを除きます。\r\n"
+		  "(簡易モニタ、グラフ表示のセンサーデータベース)\r\n"
+		  "  0:OFF  1:ON" },
+		{ E_TWEINPUTSTRING_DATATYPE_DEC, 1, 'D' },
+		{ {.u32 = 0}, {.u32 = 1 }, TWESTGS_VLD_u32MinMax, NULL },
 	},
 	{E_TWESTG_DEFSETS_VOID} // FINAL DATA
 };
@@ -224,10 +233,19 @@ const TWESTG_tsElement TWESTG_STAGE_BASE_en[] = {
 		{ TWESTG_DATATYPE_UINT32,  sizeof(uint32),  0, 0,  {.u32 = 115200}},
 		{ "BAU", "Baud Rate",
 		  "Terminal Interactive mode Specifies the baud rate.\r\n"
-		  "115200 bps is the standard, specified in 9600-115200.\r\n"
+		  "115200 bps is the standard, specified in 9600-3000000.\r\n"
 		  "The TWELITE application needs to be supported." },
-		{ E_TWEINPUTSTRING_DATATYPE_DEC, 6, 'B' },
-		{ {.u32 = 9600}, {.u32 = 1000000}, TWESTGS_VLD_u32MinMax, NULL },
+		{ E_TWEINPUTSTRING_DATATYPE_DEC, 7, 'B' },
+		{ {.u32 = 9600}, {.u32 = 3000000}, TWESTGS_VLD_u32MinMax, NULL },
+	},
+	{ E_TWESTG_STAGE_DEDUP,
+		{ TWESTG_DATATYPE_UINT8,  sizeof(uint8),  0, 0, {.u8 = 0 }},
+		{ "DUP", "Drop repeated packets",
+		  "Drops the copies of a packet relayed by repeaters.\r\n"
+		  "(Simple monitor, sensor database of Graph Viewer)\r\n"
+		  "  0:OFF  1:ON" },
+		{ E_TWEINPUTSTRING_DATATYPE_DEC, 1, 'D' },
+		{ {.u32 = 0}, {.u32 = 1 }, TWESTGS_VLD_u32MinMax, NULL },
 	},
 	{E_TWESTG_DEFSETS_VOID} // FINAL DATA
 };
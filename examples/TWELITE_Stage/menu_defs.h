@@ -22,6 +22,7 @@ typedef enum {
 	E_TWESTG_STAGE_FG_COLOR,
 	E_TWESTG_STAGE_BG_COLOR,
 	E_TWESTG_STAGE_BAUD_TERM,
+	E_TWESTG_STAGE_DEDUP,
 	// APP WRT
 	E_TWESTG_STAGE_APPWRT_START = 0x30,
 	E_TWESTG_STAGE_APPWRT_BUILD_NEXT_SCREEN,
@@ -0,0 +1,551 @@
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+/*
+ * bench (console version)
+ *
+ *   Replays serial messages through the ingest path (parse -> identify -> decode) and
+ *   reports the throughput, allocations and per-frame latency.
+ *   - The input is log files of serial output (e.g. saved by TweLogFile), or synthetic
+ *     frames of PAL(MAG,AMB,MOT)/CUE/ARIA/App_Twelite/Act/App_Uart/App_Tag if no file is given.
+ *   - Same set of codes as glancer is used, refer to Makefile(APPSRC_CXX,APPSRC_HPP).
+ *
+ *   Usage:
+ *     bench [options] [log files...]
+ *       -p auto|ascii|binary  : parser (default: auto)
+ *       -f ascii|binary|mixed : format of synthetic frames (default: ascii)
+ *       -n NUM                : number of synthetic frames (default: 100000)
+ *       -c NUM                : chunk size in bytes to feed the parser (default: 256)
+ *       -r NUM                : repeat count of the throughput run (default: 5)
+ *       -s NUM                : random seed of synthetic frames (default: 1)
+ *       -o FILE               : save the input stream into FILE (to replay it later)
+ *       -d packet|columns     : decoder, newTwePacket() or PacketColumns (default: packet)
+ *       -u NUM                : copies of each synthetic frame relayed by repeaters, dropped by
+ *                               PacketDedup before decoding (default: 0, no PacketDedup)
+ *
+ *   Results:
+ *     - throughput: bytes/s and frames/s of the whole path, fed by chunks.
+ *     - allocs/frame: count of operator new during the throughput run per frame.
+ *     - latency: p50/p99/max of the time to parse (including the bytes before the frame),
+ *       identify and decode each frame, measured one frame at a time.
+ *     - dedup (-u): the copies dropped by PacketDedup, all copies of PAL/App_Twelite/App_Tag
+ *       (only the repeater address, LQI or repeat count differ) should be dropped (exit 2 if not).
+ *       App_Uart/Act frames have no key, the same message sent again must pass.
+ *
+ *   Compile:
+ *   - GCC  -> edit the Makefile (CXX:g++ command name, CFLAGS, DEFINES, ...)
+ *   - set -DTWE_STDINOUT_ONLY, -DTWE_HAS_MILLIS (same as glancer)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "twe_common.hpp"
+#include "twe_sercmd_auto.hpp"
+#include "twe_fmt.hpp"
+#include "twe_fmt_dedup.hpp"
+#include "twe_utils_crc8.hpp"
+
+using namespace TWE;
+using namespace TWEUTILS;
+using namespace TWESERCMD;
+using namespace TWEFMT;
+
+/// count allocations (for allocs/frame)
+static uint64_t s_u64allocs = 0;
+
+void* operator new(size_t n) {
+	s_u64allocs++;
+	void* p = std::malloc(n ? n : 1);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/// payload buffer size of the parser
+const int PARSER_BUFF_SIZE = 1024;
+
+/// a sink of decoded values (not to be optimized out)
+static volatile uint32_t s_u32sink;
+
+/// count of packets by E_PKT
+static uint32_t s_au32types[8];
+
+/*****************************************************
+ * synthetic frame generator
+ *****************************************************/
+class FrameGen {
+	std::mt19937 _rng;
+	uint16_t _seq;
+
+	uint8_t _rand8() { return uint8_t(_rng()); }
+
+	// PAL header (rpt addr, LQI, seq, src addr, lid, 0x80, pcb, sensor count)
+	void _pal_header(std::vector<uint8_t>& v, uint8_t pcb, uint8_t ct) {
+		uint32_t src = 0x81000000 | (_rng() & 0xFFFF);
+		const uint8_t hdr[] = {
+			0x80, 0x00, 0x00, 0x00, _rand8(), uint8_t(_seq >> 8), uint8_t(_seq & 0xFF),
+			uint8_t(src >> 24), uint8_t(src >> 16), uint8_t(src >> 8), uint8_t(src), uint8_t(1 + _rand8() % 100),
+			0x80, pcb, ct };
+		v.assign(hdr, hdr + sizeof(hdr));
+		_seq++;
+	}
+
+	// PAL sensor data (data type, data source, ext, len, data...)
+	void _pal_data(std::vector<uint8_t>& v, uint8_t dt, uint8_t ds, uint8_t ex, const uint8_t* p, uint8_t len) {
+		v.push_back(dt); v.push_back(ds); v.push_back(ex); v.push_back(len);
+		v.insert(v.end(), p, p + len);
+	}
+	void _pal_u8(std::vector<uint8_t>& v, uint8_t ds, uint8_t ex, uint8_t d) { _pal_data(v, 0x00, ds, ex, &d, 1); }
+	void _pal_u16(std::vector<uint8_t>& v, uint8_t ds, uint8_t ex, uint16_t d) {
+		uint8_t b[] = { uint8_t(d >> 8), uint8_t(d & 0xFF) };
+		_pal_data(v, 0x01, ds, ex, b, 2);
+	}
+	void _pal_u32(std::vector<uint8_t>& v, uint8_t ds, uint8_t ex, uint32_t d) {
+		uint8_t b[] = { uint8_t(d >> 24), uint8_t(d >> 16), uint8_t(d >> 8), uint8_t(d & 0xFF) };
+		_pal_data(v, 0x02, ds, ex, b, 4);
+	}
+	void _pal_xyz(std::vector<uint8_t>& v, uint8_t ex) {
+		uint8_t b[6];
+		for (auto& x : b) x = _rand8();
+		_pal_data(v, 0x01, 0x04, ex, b, 6);
+	}
+	void _pal_crc(std::vector<uint8_t>& v) {
+		v.push_back(CRC8_u8Calc(v.data(), v.size()));
+	}
+
+public:
+	FrameGen(uint32_t seed) : _rng(seed), _seq(0) {}
+
+	// makes a copy relayed by the repeater (hop), returns false if the type has no repeater fields.
+	bool relay(std::vector<uint8_t>& v, E_PKT typ, uint8_t hop) {
+		switch (typ) {
+		case E_PKT::PKT_PAL:
+		case E_PKT::PKT_APPTAG:
+			v[0] = 0x81; v[1] = 0x00; v[2] = 0x00; v[3] = hop; // repeater address
+			v[4] = _rand8(); // LQI
+			if (typ == E_PKT::PKT_PAL) {
+				v.pop_back();
+				_pal_crc(v); // CRC covers the repeater address and LQI
+			}
+			return true;
+
+		case E_PKT::PKT_TWELITE:
+			v[4] = _rand8(); // LQI
+			v[12] = hop; // repeat count
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	// generates a payload, then returns the expected packet type.
+	E_PKT generate(std::vector<uint8_t>& v) {
+		switch (_rng() % 9) {
+		case 0: // PAL AMB
+			_pal_header(v, 0x82, 4);
+			_pal_u16(v, 0x30, 0x08, uint16_t(2800 + _rng() % 500));
+			_pal_u16(v, 0x01, 0x00, uint16_t(2000 + _rng() % 1000));
+			_pal_u16(v, 0x02, 0x00, uint16_t(4000 + _rng() % 3000));
+			_pal_u32(v, 0x03, 0x00, _rng() % 10000);
+			_pal_crc(v);
+			return E_PKT::PKT_PAL;
+
+		case 1: // PAL MAG
+			_pal_header(v, 0x81, 2);
+			_pal_u16(v, 0x30, 0x08, uint16_t(2800 + _rng() % 500));
+			_pal_u8(v, 0x00, 0x00, uint8_t(_rng() % 3));
+			_pal_crc(v);
+			return E_PKT::PKT_PAL;
+
+		case 2: // PAL MOT (16 samples)
+			_pal_header(v, 0x83, 17);
+			_pal_u16(v, 0x30, 0x08, uint16_t(2800 + _rng() % 500));
+			for (int i = 0; i < 16; i++) _pal_xyz(v, uint8_t(i));
+			_pal_crc(v);
+			return E_PKT::PKT_PAL;
+
+		case 3: // TWELITE CUE (data info, volt, mag, 10 samples)
+		{
+			const uint8_t info[] = { 0x05, 0x00, 0x00 };
+			_pal_header(v, 0x05, 14);
+			_pal_data(v, 0x00, 0x34, 0x00, info, 3);
+			_pal_u16(v, 0x30, 0x08, uint16_t(2800 + _rng() % 500));
+			_pal_u16(v, 0x30, 0x01, uint16_t(_rng() % 2000));
+			_pal_u8(v, 0x00, 0x00, uint8_t(_rng() % 3));
+			for (int i = 0; i < 10; i++) _pal_xyz(v, uint8_t(i));
+			_pal_crc(v);
+		}	return E_PKT::PKT_PAL;
+
+		case 4: // TWELITE ARIA (data info, volt, mag, temp, humid)
+		{
+			const uint8_t info[] = { 0x06, 0x00, 0x00 };
+			_pal_header(v, 0x06, 6);
+			_pal_data(v, 0x00, 0x34, 0x00, info, 3);
+			_pal_u16(v, 0x30, 0x08, uint16_t(2800 + _rng() % 500));
+			_pal_u16(v, 0x30, 0x01, uint16_t(_rng() % 2000));
+			_pal_u8(v, 0x00, 0x00, uint8_t(_rng() % 3));
+			_pal_u16(v, 0x01, 0x00, uint16_t(2000 + _rng() % 1000));
+			_pal_u16(v, 0x02, 0x00, uint16_t(4000 + _rng() % 3000));
+			_pal_crc(v);
+		}	return E_PKT::PKT_PAL;
+
+		case 5: // App_Twelite (0x81 command)
+		{
+			// :7881150175810000380026C9000C04220000FFFFFFFFFFA7
+			const uint8_t d[] = {
+				0x78, 0x81, 0x15, 0x01, 0x75, 0x81, 0x00, 0x00, 0x38, 0x00, 0x26, 0xC9,
+				0x00, 0x0C, 0x04, 0x22, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+			v.assign(d, d + sizeof(d));
+			v[4] = _rand8(); // LQI
+			v[10] = uint8_t(_seq >> 8); v[11] = uint8_t(_seq & 0xFF); _seq++; // timestamp
+			for (int i = 18; i < 22; i++) v[i] = _rand8(); // ADC
+		}	return E_PKT::PKT_TWELITE;
+
+		case 6: // Act (standard packet)
+		{
+			// :FEAA008201015A00000000B7000F424154310F0CEE000B03FF03FF03FF92
+			const uint8_t d[] = {
+				0xFE, 0xAA, 0x00, 0x82, 0x01, 0x01, 0x5A, 0x00, 0x00, 0x00, 0x00, 0xB7,
+				0x00, 0x0F, 0x42, 0x41, 0x54, 0x31, 0x0F, 0x0C, 0xEE, 0x00, 0x0B, 0x03,
+				0xFF, 0x03, 0xFF, 0x03, 0xFF };
+			v.assign(d, d + sizeof(d));
+			v[11] = _rand8(); // LQI
+			for (size_t i = 18; i < v.size(); i++) v[i] = _rand8();
+		}	return E_PKT::PKT_ACT_STD;
+
+		case 7: // App_Uart (extended format, to the parent 0x80000000)
+		{
+			// the same message from a few devices, the frames are often the same except LQI.
+			static const char msg[] = "STATUS:OK";
+			uint32_t src = 0x81000100 + _rng() % 4;
+			const uint8_t d[] = {
+				0xFE, 0xA0, 0x01, uint8_t(src >> 24), uint8_t(src >> 16), uint8_t(src >> 8), uint8_t(src),
+				0x80, 0x00, 0x00, 0x00, _rand8(), 0x00, uint8_t(sizeof(msg) - 1) };
+			v.assign(d, d + sizeof(d));
+			v.insert(v.end(), msg, msg + sizeof(msg) - 1);
+		}	return E_PKT::PKT_APPUART;
+
+		default: // App_Tag
+		{
+			// :80000000B10001810043C10032C9047C02AF0A41D2
+			const uint8_t d[] = {
+				0x80, 0x00, 0x00, 0x00, 0xB1, 0x00, 0x01, 0x81, 0x00, 0x43, 0xC1, 0x00,
+				0x32, 0xC9, 0x04, 0x7C, 0x02, 0xAF, 0x0A, 0x41 };
+			v.assign(d, d + sizeof(d));
+			v[4] = _rand8(); // LQI
+			for (size_t i = 15; i < v.size(); i++) v[i] = _rand8();
+		}	return E_PKT::PKT_APPTAG;
+		}
+	}
+};
+
+// appends a payload as ASCII format.
+static void s_append_ascii(std::vector<uint8_t>& out, const std::vector<uint8_t>& v) {
+	static const char hex[] = "0123456789ABCDEF";
+	uint8_t lrc = 0;
+
+	out.push_back(':');
+	for (auto c : v) {
+		out.push_back(hex[c >> 4]);
+		out.push_back(hex[c & 0x0F]);
+		lrc += c;
+	}
+	lrc = ~lrc + 1;
+	out.push_back(hex[lrc >> 4]);
+	out.push_back(hex[lrc & 0x0F]);
+	out.push_back(0x0D);
+	out.push_back(0x0A);
+}
+
+// appends a payload as binary format.
+static void s_append_binary(std::vector<uint8_t>& out, const std::vector<uint8_t>& v) {
+	uint8_t x = 0;
+
+	out.push_back(0xA5);
+	out.push_back(0x5A);
+	out.push_back(uint8_t(0x80 | (v.size() >> 8)));
+	out.push_back(uint8_t(v.size() & 0xFF));
+	for (auto c : v) {
+		out.push_back(c);
+		x ^= c;
+	}
+	out.push_back(x);
+	out.push_back(0x04);
+}
+
+/*****************************************************
+ * the ingest path
+ *****************************************************/
+
+// decode sensor data of PAL (as apps do).
+static void s_decode_pal(spTwePacket& pkt) {
+	auto&& pal = refTwePacketPal(pkt);
+
+	switch (pal.get_PalDataType()) {
+	case E_PAL_DATA_TYPE::AMB_STD: { auto d = pal.get_PalAmb(); s_u32sink += d.u32Lumi + d.i16Temp; } break;
+	case E_PAL_DATA_TYPE::MAG_STD: { auto d = pal.get_PalMag(); s_u32sink += d.u8MagStat; } break;
+	case E_PAL_DATA_TYPE::MOT_STD: { auto d = pal.get_PalMot(); s_u32sink += d.u8samples + d.i16X[0]; } break;
+	case E_PAL_DATA_TYPE::EX_CUE_STD: { auto d = pal.get_TweCUE(); s_u32sink += d.get_accel_count_u8(); } break;
+	case E_PAL_DATA_TYPE::EX_ARIA_STD: { auto d = pal.get_TweARIA(); s_u32sink += d.get_temp_i16_100xC(); } break;
+	default: break;
+	}
+}
+
+// duplicate suppression (-u)
+static std::unique_ptr<PacketDedup> s_dedup;
+
+// decode into columns (-d columns), the rows are consumed when full.
+static std::unique_ptr<PacketColumns> s_cols;
+static void s_on_frame_columns(IParser& parser) {
+	auto& c = *s_cols;
+	auto& payload = parser.get_payload();
+
+	if (!c.decode(payload.data(), uint16_t(payload.length()), parser.get_tick())) {
+		s_au32types[uint8_t(E_PKT::PKT_ERROR)]++;
+		return;
+	}
+
+	int i = c.size() - 1;
+	s_au32types[c.type[i] & 7]++;
+
+	if (c.full()) {
+		for (int j = 0; j < c.size(); j++) s_u32sink += c.lqi[j] + c.temp[j] + c.lumi[j] + c.mag[j] + c.accel_n[j];
+		c.clear();
+	}
+}
+
+// identify and decode a completed frame.
+static void s_on_frame(IParser& parser) {
+	if (s_dedup && !s_dedup->accept(parser)) return;
+
+	if (s_cols) {
+		s_on_frame_columns(parser);
+		return;
+	}
+
+	auto&& pkt = newTwePacket(parser);
+	auto&& typ = identify_packet_type(pkt);
+
+	if (typ == E_PKT::PKT_PAL) s_decode_pal(pkt);
+	if (pkt) s_u32sink += pkt->common.lqi;
+
+	s_au32types[uint8_t(typ) & 7]++;
+}
+
+// percentile of sorted samples
+static uint64_t s_percentile(const std::vector<uint64_t>& v, int pc) {
+	if (v.empty()) return 0;
+	size_t i = (v.size() - 1) * pc / 100;
+	return v[i];
+}
+
+template <class P>
+static int s_run(const std::vector<uint8_t>& in, size_t chunk, int repeat, long n_copies) {
+	using clock = std::chrono::steady_clock;
+
+	// pre-pass: find the end of each frame (not measured).
+	std::vector<size_t> ends;
+	{
+		P parser;
+		for (size_t i = 0; i < in.size(); i++) {
+			if (parser << char_t(in[i])) ends.push_back(i + 1);
+		}
+		if (ends.empty()) {
+			std::cerr << "no frame is found in the input." << std::endl;
+			return 1;
+		}
+	}
+
+	// throughput: feed by chunks
+	memset(s_au32types, 0, sizeof(s_au32types));
+	uint64_t n_frames = 0;
+	ParserStats stats = {};
+	uint64_t u64allocs = s_u64allocs;
+	auto t0 = clock::now();
+	for (int rep = 0; rep < repeat; rep++) {
+		if (s_dedup) { s_dedup->clear(); s_dedup->clear_counters(); } // the same input again
+		P parser;
+		for (size_t pos = 0; pos < in.size(); pos += chunk) {
+			size_t l = std::min(chunk, in.size() - pos);
+			n_frames += parser.parse(in.data() + pos, l, [](IParser& p) { s_on_frame(p); });
+		}
+		stats = parser.get_stats();
+	}
+	auto t1 = clock::now();
+	u64allocs = s_u64allocs - u64allocs;
+
+	// packet types of the throughput run (the latency pass below counts them again).
+	uint32_t au32types[8];
+	memcpy(au32types, s_au32types, sizeof(au32types));
+
+	double sec = std::chrono::duration<double>(t1 - t0).count();
+	double bytes = double(in.size()) * repeat;
+
+	// dedup counters of the last run
+	uint32_t u32dup_passed = 0, u32dup_suppressed = 0, u32dup_better = 0;
+	if (s_dedup) {
+		u32dup_passed = s_dedup->passed();
+		u32dup_suppressed = s_dedup->suppressed();
+		u32dup_better = s_dedup->better();
+		s_dedup->clear();
+	}
+
+	// latency: one frame at a time (with the bytes before it)
+	std::vector<uint64_t> lat;
+	lat.reserve(ends.size());
+	{
+		P parser;
+		size_t pos = 0;
+		for (auto e : ends) {
+			auto ts = clock::now();
+			parser.parse(in.data() + pos, e - pos, [](IParser& p) { s_on_frame(p); });
+			auto te = clock::now();
+			lat.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(te - ts).count()));
+			pos = e;
+		}
+	}
+	std::sort(lat.begin(), lat.end());
+
+	// report
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "input      : " << in.size() << " bytes, " << ends.size() << " frames" << std::endl;
+	std::cout << "parser     : frames=" << stats.u32frames << " errors=" << stats.u32errors << " cksum_errors=" << stats.u32cksum_errors << std::endl;
+	std::cout << "types      : TWELITE=" << au32types[int(E_PKT::PKT_TWELITE)]
+		<< " PAL=" << au32types[int(E_PKT::PKT_PAL)]
+		<< " APPIO=" << au32types[int(E_PKT::PKT_APPIO)]
+		<< " APPUART=" << au32types[int(E_PKT::PKT_APPUART)]
+		<< " APPTAG=" << au32types[int(E_PKT::PKT_APPTAG)]
+		<< " ACT_STD=" << au32types[int(E_PKT::PKT_ACT_STD)]
+		<< " ERROR=" << au32types[int(E_PKT::PKT_ERROR)]
+		<< " (of the throughput run)" << std::endl;
+	std::cout << "throughput : " << bytes / sec / 1e6 << " MB/s, " << double(n_frames) / sec / 1e3 << " kframes/s" << std::endl;
+	std::cout << "allocs     : " << std::setprecision(2) << (n_frames ? double(u64allocs) / double(n_frames) : 0.) << " /frame" << std::endl;
+	std::cout << "latency    : p50=" << s_percentile(lat, 50) << "ns p99=" << s_percentile(lat, 99) << "ns max=" << lat.back() << "ns" << std::endl;
+
+	if (s_dedup) {
+		std::cout << "dedup      : passed=" << u32dup_passed << " suppressed=" << u32dup_suppressed << " (better LQI=" << u32dup_better << ")";
+		if (n_copies >= 0) {
+			// synthetic frames: all the copies should be dropped.
+			bool b_ok = (long(u32dup_suppressed) == n_copies);
+			std::cout << " copies=" << n_copies << (b_ok ? " OK" : " NG") << std::endl;
+			if (!b_ok) return 2;
+		}
+		else std::cout << std::endl;
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	std::string opt_parser = "auto";
+	std::string opt_fmt = "ascii";
+	std::string opt_out;
+	std::string opt_dec = "packet";
+	size_t n_frames = 100000;
+	size_t chunk = 256;
+	int repeat = 5;
+	uint32_t seed = 1;
+	int n_relay = 0;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		bool has_arg = (i + 1 < argc);
+
+		if (a == "-p" && has_arg) opt_parser = argv[++i];
+		else if (a == "-f" && has_arg) opt_fmt = argv[++i];
+		else if (a == "-n" && has_arg) n_frames = size_t(std::strtoul(argv[++i], nullptr, 0));
+		else if (a == "-c" && has_arg) chunk = size_t(std::strtoul(argv[++i], nullptr, 0));
+		else if (a == "-r" && has_arg) repeat = std::atoi(argv[++i]);
+		else if (a == "-s" && has_arg) seed = uint32_t(std::strtoul(argv[++i], nullptr, 0));
+		else if (a == "-o" && has_arg) opt_out = argv[++i];
+		else if (a == "-d" && has_arg) opt_dec = argv[++i];
+		else if (a == "-u" && has_arg) n_relay = std::atoi(argv[++i]);
+		else if (a[0] == '-') {
+			std::cerr << "usage: bench [-p auto|ascii|binary] [-f ascii|binary|mixed] [-n frames] [-c chunk] [-r repeat] [-s seed] [-o file] [-d packet|columns] [-u copies] [log files...]" << std::endl;
+			return 1;
+		}
+		else files.push_back(a);
+	}
+	if (chunk == 0) chunk = 1;
+	if (repeat < 1) repeat = 1;
+
+	// input stream
+	std::vector<uint8_t> in;
+	long n_copies = -1; // copies relayed by repeaters (-u), -1: unknown (log files)
+	if (!files.empty()) {
+		for (auto& f : files) {
+			std::ifstream ifs(f, std::ios::binary);
+			if (!ifs) {
+				std::cerr << "cannot open " << f << std::endl;
+				return 1;
+			}
+			in.insert(in.end(), std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+		}
+	}
+	else {
+		FrameGen gen(seed);
+		std::mt19937 rng_fmt(seed);
+		n_copies = 0;
+		std::vector<uint8_t> v;
+		for (size_t i = 0; i < n_frames; i++) {
+			E_PKT typ = gen.generate(v);
+			for (int hop = 0; hop <= n_relay; hop++) {
+				if (hop > 0) {
+					if (!gen.relay(v, typ, uint8_t(hop))) break;
+					n_copies++;
+				}
+				bool b_bin = (opt_fmt == "binary") || (opt_fmt == "mixed" && (rng_fmt() & 1));
+				if (b_bin) s_append_binary(in, v);
+				else s_append_ascii(in, v);
+			}
+		}
+	}
+
+	if (!opt_out.empty()) {
+		std::ofstream ofs(opt_out, std::ios::binary);
+		ofs.write(reinterpret_cast<const char*>(in.data()), std::streamsize(in.size()));
+	}
+
+	if (opt_dec == "columns") s_cols.reset(new PacketColumns(256));
+	if (n_relay > 0) s_dedup.reset(new PacketDedup(256, PacketDedup::DEFAULT_WINDOW_MS, false));
+
+	std::cout << "parser=" << opt_parser << " decoder=" << opt_dec << " chunk=" << chunk << " repeat=" << repeat << std::endl;
+	if (opt_parser == "ascii") return s_run<AsciiParserT<PARSER_BUFF_SIZE>>(in, chunk, repeat, n_copies);
+	if (opt_parser == "binary") return s_run<BinaryParserT<PARSER_BUFF_SIZE>>(in, chunk, repeat, n_copies);
+	return s_run<AutoParserT<PARSER_BUFF_SIZE>>(in, chunk, repeat, n_copies);
+}
+
+/// implement millis()
+#if defined(_MSC_VER) || defined(__MINGW32__)
+#include "windows.h"
+# pragma comment(lib, "winmm.lib")
+#elif defined(__APPLE__) || defined(__linux)
+#include <sys/time.h>
+#endif
+
+uint32_t millis() {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	return (uint32_t)timeGetTime();
+#elif defined(__APPLE__) || defined(__linux)
+	timeval time;
+	gettimeofday(&time, NULL);
+	long ms = (time.tv_sec * 1000) + (time.tv_usec / 1000);
+	return (uint32_t)ms;
+#else
+	# warning "no u32GetTick_ms() implementation."
+	return 0;
+#endif
+}
@@ -39,7 +39,7 @@ using namespace TWEUTILS;
 using namespace TWESERCMD;
 using namespace TWEFMT;
 
-AsciiParser parse_ascii(256);
+AsciiParserT<256> parse_ascii;
 
 void print_unknown(TWEUTILS::SmplBuf_Byte& payl) {
 	std::cout << ":MSG=0x";
@@ -62,8 +62,11 @@ APPSRC_CXX+=twe_fmt_actstd.cpp
 APPSRC_CXX+=twe_fmt_appio.cpp
 APPSRC_CXX+=twe_fmt_apptag.cpp
 APPSRC_CXX+=twe_fmt_appuart.cpp
+APPSRC_CXX+=twe_fmt_batch.cpp
+APPSRC_CXX+=twe_fmt_dedup.cpp
 APPSRC_CXX+=twe_fmt_common.cpp
 APPSRC_CXX+=twe_fmt_pal.cpp
+APPSRC_CXX+=twe_fmt_record.cpp
 APPSRC_CXX+=twe_fmt_twelite.cpp
 APPSRC_CXX+=twe_sercmd_binary.cpp
 APPSRC_CXX+=twe_cui_listview.cpp
@@ -33,3 +33,11 @@
 #if !defined(MWM5_MOUSE_RDBLCLK_TO_ESC_TIMEOUT)
 # define MWM5_MOUSE_RDBLCLK_TO_ESC_TIMEOUT 500
 #endif
+
+// Serial reader thread (requires MWM5_SDL2_USE_MULTITHREAD_RENDER == 1)
+// if set 1, a dedicated thread blocks in the serial driver and fills the
+// receive queue, the application loop is woken on data arrival.
+// - if set 0, activate by command arg "-T 1"
+#if !defined(MWM5_SERIAL_USE_READER_THREAD)
+# define MWM5_SERIAL_USE_READER_THREAD 0
+#endif
@@ -36,6 +36,7 @@
 // for thread
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 // for check file content
 #include <regex>
@@ -245,6 +246,11 @@ TWE_PutChar_CONIO TWE::WrtCon;
 #	endif
 #endif
 
+#if defined(MWM5_SERIAL_MULTI)
+// additional ports (opened by -M option)
+SerialMulti<SerialFtdi> TWE::the_serial_multi;
+#endif
+
 // the M5 stack instance
 #if M5_SCREEN_HIRES == 0
 static const int M5_LCD_WIDTH = 320;
@@ -262,6 +268,10 @@ struct _gen_preference {
 	int render_engine;    // choose rendering option (osx Metal)
 	int serial_safe_mode; // choose serial safe modes
 	int game_controller;  // 0: not use, 1: use game controller
+	int serial_reader_thread; // 0: not use, 1: use the serial reader thread
+	int headless;         // 0: normal, 1: no window and no rendering (console only)
+	char multi_port[SerialPortEntries::SERPORT_ENT_MAX][32]; // additional ports (-M devname)
+	int multi_port_count;
 
 	bool b_geom;
 	int geom_x;
@@ -304,6 +314,12 @@ struct app_core_generic_procs {
 		the_clip.paste.past_from_clip();
 	}
 
+	// request to show the receive path statistics (handled in s_sketch_loop())
+	std::atomic<bool> b_req_rx_stats{ false };
+	void rx_stats_request() {
+		b_req_rx_stats = true;
+	}
+
 	void open_lib_dir(const wchar_t *projname, const wchar_t *app_open = nullptr) {
 		auto&& dir_project = make_full_path(the_cwd.get_dir_sdk_twenet_lib(), "src", projname);
 		
@@ -749,10 +765,12 @@ struct app_core_sdl {
 		sub_textediting.force_refresh();
 
 		// quit button
-		sp_btn_quit->setup(gRenderer);
-		sp_btn_A->setup(gRenderer);
-		sp_btn_B->setup(gRenderer);
-		sp_btn_C->setup(gRenderer);
+		if (gRenderer != nullptr) { // no renderer when headless.
+			sp_btn_quit->setup(gRenderer);
+			sp_btn_A->setup(gRenderer);
+			sp_btn_B->setup(gRenderer);
+			sp_btn_C->setup(gRenderer);
+		}
 
 		// render help screen
 		update_help_screen();
@@ -1344,6 +1362,18 @@ struct app_core_sdl {
 				}
 				break;
 
+			case SDL_SCANCODE_U:
+				if (e.type == SDL_KEYDOWN) {
+					update_help_desc(MLSLW(
+						L"シリアル受信の統計情報をコンソールに表示します",
+						L"Show statistics of serial receiving on the console."
+					));
+				} else {
+					the_generic_ops.rx_stats_request();
+					bhandled = true;
+				}
+				break;
+
 			case SDL_SCANCODE_J:
 				if (e.type == SDL_KEYDOWN) {
 					update_help_desc(MLSLW(
@@ -1769,10 +1799,41 @@ struct app_core_sdl {
 	}
 
 	void setup() {
-		init_sdl();
+		if (!the_pref.headless) init_sdl();
 		init_sdl_sub();
 	}
 
+	/**
+	 * @fn	void app_core_sdl::loop_headless()
+	 *
+	 * @brief	Main loop without window and rendering.
+	 * 			The app loop runs without waiting VSYNC, it only waits for serial data
+	 * 			(with the reader thread) or a short time.
+	 */
+	void loop_headless() {
+		SDL_Event e;
+
+		while (g_quit_sdl_loop == false) {
+			while (SDL_PollEvent(&e) != 0) {
+				if (e.type == SDL_QUIT) g_quit_sdl_loop = true;
+			}
+
+			::s_sketch_loop();
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			if (Serial2.is_reader_thread_running()) {
+				Serial2.wait_rx(LOOP_MS_HEADLESS);
+				continue;
+			}
+#endif
+			SDL_Delay(1);
+		}
+
+		con_screen << crlf << "exiting";
+		con_screen.refresh();
+	}
+	static const int LOOP_MS_HEADLESS = 10; // max wait for serial data
+
 	void loop() {
 		SDL_Event e;
 		SDL_Point screenCenter = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 };
@@ -2022,6 +2083,25 @@ static void s_init() {
 static void s_init_sdl() {
 	SDL_SetMainReady();
 
+	if (the_pref.headless) {
+		// no video, only events (SDL_QUIT, user event) and timer.
+		if (SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER) < 0) {
+			exit_err("SDL_Init() [%s]");
+		}
+
+		if ((g_sdl2_user_event_type = SDL_RegisterEvents(1)) == -1) {
+			exit_err("SDL_RegisterEvents()");
+		}
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1 && MWM5_USE_SDL2_MUTEX == 1
+		gMutex_Render = SDL_CreateMutex();
+		if (gMutex_Render == nullptr) {
+			exit_err("SDL_CreateMutex()");
+		}
+#endif
+		return;
+	}
+
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER 
 				                | (the_pref.game_controller ? SDL_INIT_GAMECONTROLLER : 0)
 	            ) < 0) {
@@ -2113,6 +2193,45 @@ static void s_sketch_setup() {
 	::setup();
 }
 
+/**
+ * @fn	static void s_show_rx_stats()
+ *
+ * @brief	Shows the health counters of the receive path on the console.
+ */
+static void s_show_rx_stats() {
+	auto s = Serial2.get_rx_stats();
+	con_screen << crlf << printfmt("[RX] bytes=%u dropped=%u full=%u hwm=%u/%u tick_merged=%u"
+		, s.u32bytes_rx, s.u32bytes_dropped, s.u32que_full, s.u32que_hwm, s.u32que_capacity, s.u32tick_merged);
+
+	con_screen << crlf << printfmt("[RX] update(%u):", s.u32update_ct);
+	for (int i = 0; i < SerialRxStats::HIST_N; i++) {
+		if (i < SerialRxStats::HIST_N - 1)
+			con_screen << printfmt(" <%uus:%u", SerialRxStats::hist_bound_us(i), s.au32update_hist[i]);
+		else
+			con_screen << printfmt(" more:%u", s.au32update_hist[i]);
+	}
+
+	auto q = the_uart_queue.get_stats();
+	con_screen << crlf << printfmt("[APP QUE] pushed=%u dropped=%u hwm=%u/%u tick_merged=%u"
+		, q.u32pushed, q.u32dropped, q.u32high_water, q.u32capacity, q.u32tick_merged);
+
+	if (the_uart_parser) {
+		auto& p = the_uart_parser->get_stats();
+		con_screen << crlf << printfmt("[APP PARSER] frames=%u err=%u cksum=%u"
+			, p.u32frames, p.u32errors, p.u32cksum_errors);
+	}
+
+#if defined(MWM5_SERIAL_MULTI)
+	for (int i = 1; i <= the_serial_multi.count(); i++) {
+		auto r = the_serial_multi.get_serial(i)->get_rx_stats();
+		auto p = the_serial_multi.get_port_stats(i);
+		con_screen << crlf << printfmt("[PORT %d] bytes=%u dropped=%u", i, r.u32bytes_rx, r.u32bytes_dropped)
+			<< printfmt(" pkts=%u(lost %u) err=%u cksum=%u", p.u32pkts, p.u32dropped, p.parser.u32errors, p.parser.u32cksum_errors);
+	}
+#endif
+	con_screen << crlf;
+}
+
 static void s_sketch_loop() {
 	// update tick counter
 	u32TickCount_ms = TWESYS::u32GetTick_ms();
@@ -2120,14 +2239,23 @@ static void s_sketch_loop() {
 	// get serial2 buffer
 	int nSer2 = Serial2.update();
 
+#if defined(MWM5_SERIAL_MULTI)
+	// read additional ports (packets are merged in the_serial_multi)
+	the_serial_multi.update();
+#endif
+
 	// console test
 	if (!twe_prog.is_protocol_busy()) {
 		// handle serial input from TWE
 		if (nSer2 >= 1) {
-			for (int i = 0; i < nSer2; i++) {
-				char_t c = Serial2._get_last_buf(i);
-				con_screen << c;
-				the_app_core->log_write(c);
+			// the received bytes (may be two spans of the ring buffer)
+			auto span = Serial2.get_last_span();
+			for (int j = 0; j < 2; j++) {
+				for (int i = 0; i < span.len[j]; i++) {
+					char_t c = span.p[j][i];
+					con_screen << c;
+					the_app_core->log_write(c);
+				}
 			}
 		}
 
@@ -2184,6 +2312,11 @@ static void s_sketch_loop() {
 			if (c >= 0) the_sys_keyboard.push(c & 0xFF); // WrtTWE << char_t(c & 0xFF);
 		}
 
+		// show statistics (requested by Alt+U)
+		if (the_generic_ops.b_req_rx_stats.exchange(false)) {
+			s_show_rx_stats();
+		}
+
 		con_screen.refresh();
 
 		::loop(); // external loop()
@@ -2246,6 +2379,7 @@ static void s_getopt(int argc, char* args[]) {
 	// clear preference data and set defaults
 	memset(&the_pref, 0, sizeof(the_pref));
 	the_pref.game_controller = MWM5_USE_GAMECONTROLLER;
+	the_pref.serial_reader_thread = MWM5_SERIAL_USE_READER_THREAD;
 
 	the_pref.geom_x = SDL_WINDOWPOS_UNDEFINED;
 	the_pref.geom_y = SDL_WINDOWPOS_UNDEFINED;
@@ -2254,7 +2388,7 @@ static void s_getopt(int argc, char* args[]) {
 	int opt = 0;
 	ts_opt_getopt* popt = oss_getopt_ref();
 
-    while ((opt = oss_getopt(argc, args, "E:R:x:y:")) != -1) {
+    while ((opt = oss_getopt(argc, args, "E:HM:R:T:x:y:")) != -1) {
         switch (opt) {
 		case 'E': // effects
 			{
@@ -2274,6 +2408,20 @@ static void s_getopt(int argc, char* args[]) {
 			the_pref.game_controller = 1;
 			break;
 
+		case 'H': // headless (no window, no rendering)
+			the_pref.headless = 1;
+			break;
+
+		case 'M': // additional port opened at the same time (can be specified multiple times)
+			if (the_pref.multi_port_count < SerialPortEntries::SERPORT_ENT_MAX) {
+				snprintf(the_pref.multi_port[the_pref.multi_port_count++], sizeof(the_pref.multi_port[0]), "%s", popt->optarg);
+			}
+			break;
+
+		case 'T': // serial reader thread (0:disable 1:enable)
+			the_pref.serial_reader_thread = atoi(popt->optarg);
+			break;
+
 		case 'x':
 			the_pref.geom_x = atoi(popt->optarg);
 			the_pref.b_geom = true;
@@ -2459,6 +2607,23 @@ static uint32_t callbackTimerApp(uint32_t interval, void* param) {
 
 	return T_LOOP;
 }
+
+/**
+ * @fn	static void s_app_loop_thread()
+ *
+ * @brief	Application loop thread (used with the serial reader thread instead of SDL Timer).
+ * 			The loop is woken when the reader thread receives data, otherwise
+ * 			run at the same period of callbackTimerApp().
+ */
+static void s_app_loop_thread() {
+	uint32_t t_next = 10;
+
+	while (!g_quit_sdl_loop) {
+		Serial2.wait_rx(t_next); // wake on data arrival or timeout
+		t_next = callbackTimerApp(t_next, nullptr);
+		if (t_next == 0) break;
+	}
+}
 #endif
 
 /**
@@ -2557,13 +2722,53 @@ int main(int argc, char* args[]) {
 	// call sketch setup();
 	s_sketch_setup();
 
+#if defined(MWM5_SERIAL_MULTI)
+	// open additional ports (not the one of Serial2)
+	the_serial_multi.set_primary(Serial2);
+	for (int i = 0; i < the_pref.multi_port_count; i++) {
+		int port = the_serial_multi.open(the_pref.multi_port[i]);
+		if (port > 0) {
+			con_screen << printfmt("[PORT %d] %s", port, the_pref.multi_port[i]) << crlf;
+		} else {
+			con_screen << printfmt("[PORT] cannot open %s", the_pref.multi_port[i]) << crlf;
+		}
+	}
+#endif
+
 #if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
-	// main loop is invoked by SDL Timer.
-	SDL_AddTimer(10, callbackTimerApp, nullptr);
+	std::thread th_app;
+	if (the_pref.serial_reader_thread) {
+		// serial data is read by the dedicated thread, which wakes the app loop thread.
+		Serial2.begin_reader_thread();
+# if defined(MWM5_SERIAL_MULTI)
+		the_serial_multi.begin_reader_threads();
+# endif
+		if (!the_pref.headless) th_app = std::thread(s_app_loop_thread);
+	} else if (!the_pref.headless) {
+		// main loop is invoked by SDL Timer.
+		SDL_AddTimer(10, callbackTimerApp, nullptr);
+	}
 #endif
 
 	// SDL MainLoop
-	the_app_core->loop();
+	if (the_pref.headless) {
+		the_app_core->loop_headless(); // the app loop runs in this thread.
+	} else {
+		the_app_core->loop();
+	}
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+	if (th_app.joinable()) {
+		g_quit_sdl_loop = true;
+		th_app.join();
+	}
+	if (the_pref.serial_reader_thread) {
+		Serial2.end_reader_thread();
+# if defined(MWM5_SERIAL_MULTI)
+		the_serial_multi.end_reader_threads();
+# endif
+	}
+#endif
 
 	// exiting thread.
 	auto func = [](uint32_t timeout) {
@@ -9,6 +9,15 @@
 #include "sdl2_config.h"
 # include "sdl2_utils.hpp" 
 
+#include <chrono>
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <atomic>
+#endif
+
 namespace TWE {
     class SerialPortEntries {
 	protected:
@@ -26,6 +35,64 @@ namespace TWE {
         SerialPortEntries() {}
     };
 
+	/**
+	 * @struct	SerialRxSpan
+	 *
+	 * @brief	received bytes as two contiguous spans (the second one is used when
+	 * 			the data is wrapped around in the ring buffer).
+	 */
+	struct SerialRxSpan {
+		const uint8_t* p[2];
+		int len[2];
+
+		SerialRxSpan() : p{ nullptr, nullptr }, len{ 0, 0 } {}
+		SerialRxSpan(const void* p1, int l1, const void* p2 = nullptr, int l2 = 0)
+			: p{ (const uint8_t*)p1, (const uint8_t*)p2 }, len{ l1, l2 } {}
+
+		inline int size() const { return len[0] + len[1]; }
+		inline int operator[](int i) const {
+			if (i >= 0 && i < len[0]) return p[0][i];
+			i -= len[0];
+			if (i >= 0 && i < len[1]) return p[1][i];
+			return -1;
+		}
+	};
+
+	/**
+	 * @struct	SerialRxStats
+	 *
+	 * @brief	health counters of the receive path (see SerialCommon::get_rx_stats()).
+	 */
+	struct SerialRxStats {
+		static const int HIST_N = 8; // buckets of update() duration
+
+		uint32_t u32bytes_rx;      // bytes stored into the queue
+		uint32_t u32bytes_dropped; // bytes lost as the queue had no space
+		uint32_t u32que_full;      // times a push into the queue failed (received bytes were dropped)
+		uint32_t u32que_hwm;       // high water mark of the queue
+		uint32_t u32que_capacity;  // size of the queue
+		uint32_t u32tick_merged;   // ranges merged into the previous arrival tick (the mark queue was full)
+		uint32_t u32update_ct;     // calls of the driver's _update()
+		uint32_t au32update_hist[HIST_N]; // histogram of _update() duration (see hist_bound_us())
+
+		/**
+		 * @fn	static uint32_t SerialRxStats::hist_bound_us(int i)
+		 *
+		 * @brief	upper bound of the histogram bucket i in usec (the last bucket has no bound).
+		 */
+		static uint32_t hist_bound_us(int i) {
+			static const uint32_t bounds[HIST_N - 1] = { 10, 30, 100, 300, 1000, 3000, 10000 };
+			return (i >= 0 && i < HIST_N - 1) ? bounds[i] : 0xFFFFFFFF;
+		}
+
+		void add_update_us(uint32_t us) {
+			int i = 0;
+			while (i < HIST_N - 1 && us >= hist_bound_us(i)) i++;
+			au32update_hist[i]++;
+			u32update_ct++;
+		}
+	};
+
     template <class CDER>
     class SerialCommon : public SerialPortEntries {
 		friend CDER;
@@ -40,10 +107,16 @@ namespace TWE {
 		int _devname_opened_idx;
 
         TWEUTILS::FixedQueue<uint8_t> _que; // primary buffer (used when read() is called.)
+		TWEUTILS::TickMarks<TWEUTILS::FixedQueue<TWEUTILS::TickMark>> _que_marks; // arrival ticks of _que (locked with _que)
 
 		char _buf[SIZ_READ_BUFF]; // secondary buffer (used for system API.)
 		int _buf_len; // size of effective data in _buf[]
 
+		SerialRxSpan _span_rx; // received by the last _update() (set by the driver, otherwise _buf[] is used)
+		SerialRxSpan _span_last; // received by the last update()
+
+		SerialRxStats _stats; // health counters (bytes/hwm: _mtx_queue, others: _mtx_rx)
+
         void (*_hook_on_write)(const uint8_t* p, int len); // hook function when writing.
 
         int _session_id; // -1:no_session or positive value
@@ -69,13 +142,38 @@ namespace TWE {
 		const bool _mtx_tx = true;
 #endif
 
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+		// reader thread context (created by begin_reader_thread())
+		struct _reader_context {
+			static const int WAIT_RX_MS = 10; // max wait in driver's _wait_rx()
+
+			std::thread th;
+			std::atomic<bool> b_run;
+
+			std::mutex mtx_notify;
+			std::condition_variable cv_notify;
+			bool b_notified;
+
+			TWEUTILS::FixedQueue<uint8_t> que_echo; // received by the thread, not passed by update() yet.
+			char buf_echo[SIZ_READ_BUFF]; // the bytes passed by the last update().
+			int buf_echo_len;
+
+			_reader_context() : th(), b_run(false), mtx_notify(), cv_notify(), b_notified(false)
+				, que_echo(SIZ_READ_BUFF * 4), buf_echo(), buf_echo_len(0) {}
+		};
+		std::unique_ptr<_reader_context> _reader;
+#endif
+
     public:
         SerialCommon(size_t bufsize = 2048) : 
 			  _devname(), _devname_prev(), _devname_extra_info()
 			, _devname_opened_idx(-1)
             , _que(TWEUTILS::FixedQueue<uint8_t>::size_type(bufsize))
+			, _que_marks(TWEUTILS::FixedQueue<TWEUTILS::TickMark>::size_type(bufsize / 16 > 64 ? bufsize / 16 : 64)) // a mark per 16 bytes
             , _buf()
             , _buf_len(0)
+			, _span_rx(), _span_last()
+			, _stats()
             , _hook_on_write(nullptr)
             , _session_id(-1)
 			, _modctl_capable(false)
@@ -88,6 +186,12 @@ namespace TWE {
 #endif
 		}
 
+		~SerialCommon() {
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			end_reader_thread();
+#endif
+		}
+
 		void _set_modctl_capable(bool n) { _modctl_capable = n; } // may set internally when opened.
 		int get_modctl_capable() { return _modctl_capable; }
 
@@ -141,7 +245,10 @@ namespace TWE {
 			_modctl_capable = ser_modctl_mode[devidx]; // check if the device name is TWELITE-R (modctl capable)
 
 			// open it (call method by CTRP)
-			bool ret = static_cast<CDER&>(*this)._open(devname);
+			bool ret = false;
+			if (auto l = TWE::LockGuard(_mtx_rx)) { // the reader thread may be running.
+				ret = static_cast<CDER&>(*this)._open(devname);
+			}
 
 			// success!
 			if (ret) {
@@ -163,7 +270,9 @@ namespace TWE {
          * @brief	Closes this port
          */
 	    void close() { 
-			static_cast<CDER&>(*this)._close();
+			if (auto l = TWE::LockGuard(_mtx_rx)) { // the reader thread may be in _update().
+				static_cast<CDER&>(*this)._close();
+			}
 			_devname_opened_idx = -1;
 			_session_id = -1;
 			_devname[0] = 0; // clear _devname as well
@@ -211,6 +320,37 @@ namespace TWE {
 			return _session_id != -1;
 		}
 	public:
+        /**
+		 * @fn	SerialRxStats SerialCommon::get_rx_stats()
+		 *
+		 * @brief	Gets the health counters of the receive path.
+		 *
+		 * @returns	a copy of the counters.
+		 */
+		SerialRxStats get_rx_stats() {
+			SerialRxStats s = SerialRxStats();
+			if (auto l = TWE::LockGuard(_mtx_rx)) {
+				if (auto lq = TWE::LockGuard(_mtx_queue)) {
+					s = _stats;
+					s.u32que_capacity = uint32_t(_que.capacity());
+				}
+			}
+			return s;
+		}
+
+        /**
+		 * @fn	void SerialCommon::reset_rx_stats()
+		 *
+		 * @brief	Resets the health counters.
+		 */
+		void reset_rx_stats() {
+			if (auto l = TWE::LockGuard(_mtx_rx)) {
+				if (auto lq = TWE::LockGuard(_mtx_queue)) {
+					_stats = SerialRxStats();
+				}
+			}
+		}
+
 		bool is_opened() {
 			bool r = false;
 			r = _is_opened();
@@ -285,14 +425,28 @@ namespace TWE {
 		int _get_last_buf(int i) {
 			int r = -1;
 			if (auto l = TWE::LockGuard(_mtx_rx)) {
-				if (i >= 0 && i < _buf_len) {
-					r = _buf[i];
-				}
+				r = _span_last[i];
 			}
 
 			return r;
 		}
 
+        /**
+		 * @fn	SerialRxSpan SerialCommon::get_last_span()
+		 *
+		 * @brief	Gets the bytes received by the last update() as span(s).
+		 * 			The span is valid till next update() is called.
+		 *
+		 * @returns	The span(s) of received bytes.
+		 */
+		SerialRxSpan get_last_span() {
+			SerialRxSpan r;
+			if (auto l = TWE::LockGuard(_mtx_rx)) {
+				r = _span_last;
+			}
+			return r;
+		}
+
         /**
 		 * @fn	bool SerialCommon::available()
 		 *
@@ -321,6 +475,7 @@ namespace TWE {
 				if (!_que.empty()) {
 					uint8_t c = _que.front();
 					_que.pop();
+					_que_marks.on_pop(1);
 
 					r = c;
 				}
@@ -329,6 +484,139 @@ namespace TWE {
 			return r;
 		}
 
+        /**
+		 * @fn	int SerialCommon::read(uint8_t* p, int len)
+		 *
+		 * @brief	read up to len bytes (from _que) at once.
+		 * 			The queue is locked only once for the whole chunk.
+		 *
+		 * @param [out]	p  	destination buffer.
+		 * @param 		len	size of the destination buffer.
+		 *
+		 * @returns	number of bytes read. (0: no data)
+		 */
+		int read(uint8_t* p, int len) {
+			uint32_t tick;
+			return read(p, len, tick);
+		}
+
+        /**
+		 * @fn	int SerialCommon::read(uint8_t* p, int len, uint32_t& tick)
+		 *
+		 * @brief	read up to len bytes, which are received at once by the driver.
+		 *
+		 * @param [out]	p   	destination buffer.
+		 * @param 		len 	size of the destination buffer.
+		 * @param [out]	tick	arrival tick of the bytes (TWESYS::u32GetTick_ms(), 0:unknown).
+		 *
+		 * @returns	number of bytes read. (0: no data)
+		 */
+		int read(uint8_t* p, int len, uint32_t& tick) {
+			int r = 0;
+			tick = 0;
+			if (len <= 0) return 0;
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				uint32_t n = uint32_t(len);
+				tick = _que_marks.limit(n);
+				r = _que.pop_front(p, TWEUTILS::FixedQueue<uint8_t>::size_type(n));
+				_que_marks.on_pop(r);
+			}
+			return r;
+		}
+
+	protected:
+		/**
+		 * @fn	int SerialCommon::_que_push(const uint8_t* p, int len)
+		 *
+		 * @brief	push received bytes into _que at once (called from _update() of the driver).
+		 *
+		 * @param	p  	received bytes.
+		 * @param	len	length of them.
+		 *
+		 * @returns	number of bytes stored.
+		 */
+		int _que_push(const uint8_t* p, int len) {
+			int r = 0;
+			uint32_t tick = TWESYS::u32GetTick_ms(); // arrival tick
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				r = _que.push(p, TWEUTILS::FixedQueue<uint8_t>::size_type(len));
+				if (!_que_marks.on_push(r, tick)) _stats.u32tick_merged++;
+				_stat_on_push(r, len - r);
+			}
+			return r;
+		}
+
+		/**
+		 * @fn	int SerialCommon::_que_free_spans(uint8_t*& p1, int& n1, uint8_t*& p2, int& n2)
+		 *
+		 * @brief	get the free region of _que, so that the driver reads into it directly.
+		 * 			(only the driver writes into the free region, the lock is needed to get the spans.)
+		 *
+		 * @returns	total length of the free region.
+		 */
+		int _que_free_spans(uint8_t*& p1, int& n1, uint8_t*& p2, int& n2) {
+			TWEUTILS::FixedQueue<uint8_t>::size_type l1 = 0, l2 = 0;
+			p1 = p2 = nullptr;
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				_que.free_spans(p1, l1, p2, l2);
+			}
+			n1 = l1;
+			n2 = l2;
+			return n1 + n2;
+		}
+
+		/**
+		 * @fn	void SerialCommon::_que_commit(int len)
+		 *
+		 * @brief	store len bytes written into the spans by _que_free_spans().
+		 */
+		void _que_commit(int len) {
+			uint32_t tick = TWESYS::u32GetTick_ms(); // arrival tick
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				_que.commit_push(TWEUTILS::FixedQueue<uint8_t>::size_type(len));
+				if (!_que_marks.on_push(len, tick)) _stats.u32tick_merged++;
+				_stat_on_push(len, 0);
+			}
+		}
+
+		// update counters (called with _mtx_queue locked)
+		void _stat_on_push(int n_stored, int n_dropped) {
+			_stats.u32bytes_rx += uint32_t(n_stored);
+			if (n_dropped > 0) {
+				_stats.u32bytes_dropped += uint32_t(n_dropped);
+				_stats.u32que_full++;
+			}
+			if (_que.size() > _stats.u32que_hwm) _stats.u32que_hwm = _que.size();
+		}
+
+		/**
+		 * @fn	void SerialCommon::_que_clear()
+		 *
+		 * @brief	clear _que (and arrival ticks)
+		 */
+		void _que_clear() {
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				_que.clear();
+				_que_marks.clear();
+			}
+		}
+
+		/**
+		 * @fn	int SerialCommon::_que_free()
+		 *
+		 * @brief	free space of _que, one byte is kept as a margin.
+		 *
+		 * @returns	bytes can be stored.
+		 */
+		int _que_free() {
+			int r = 0;
+			if (auto l = TWE::LockGuard(_mtx_queue)) {
+				r = int(_que.capacity()) - int(_que.size()) - 1;
+			}
+			return r < 0 ? 0 : r;
+		}
+
+	public:
         /**
 		 * @fn	int SerialCommon::write(const uint8_t* p, int len)
 		 *
@@ -364,11 +652,159 @@ namespace TWE {
 		int update() {
 			int r = 0;
 			if (auto l = TWE::LockGuard(_mtx_rx)) {
-				r = static_cast<CDER&>(*this)._update();
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+				if (_reader) {
+					// data is already in _que, pass the bytes received since the last call.
+					r = _reader->que_echo.pop_front((uint8_t*)_reader->buf_echo, sizeof(_reader->buf_echo));
+					_reader->buf_echo_len = r;
+					_span_last = SerialRxSpan(_reader->buf_echo, r);
+				} else
+#endif
+				{
+					r = _update_span();
+					_span_last = _span_rx;
+				}
 			}
 			return r;
         }
 
+	private:
+		// call driver's _update() and set _span_rx.
+		int _update_span() {
+			auto t0 = std::chrono::steady_clock::now();
+
+			_span_rx = SerialRxSpan();
+			int r = static_cast<CDER&>(*this)._update();
+
+			auto dt = std::chrono::steady_clock::now() - t0;
+			_stats.add_update_us(uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(dt).count()));
+
+			if (r > 0 && _span_rx.size() == 0) _span_rx = SerialRxSpan(_buf, r); // the driver used _buf[].
+			if (r <= 0) _span_rx = SerialRxSpan();
+			return r;
+		}
+
+	public:
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+		/**
+		 * @fn	bool SerialCommon::begin_reader_thread()
+		 *
+		 * @brief	Starts the reader thread, which waits for incoming data in the driver
+		 * 			(_wait_rx()) and stores it into _que continuously.
+		 * 			While running, update() does not access the driver, but returns
+		 * 			the bytes received since the last call (for console/log output).
+		 *
+		 * @returns	True if it succeeds, false if it fails.
+		 */
+		bool begin_reader_thread() {
+			if (_reader) return true;
+
+			_reader.reset(new _reader_context());
+			_reader->b_run = true;
+			_reader->th = std::thread([this]() { _reader_thread_main(); });
+
+			return true;
+		}
+
+		/**
+		 * @fn	void SerialCommon::end_reader_thread()
+		 *
+		 * @brief	Stops the reader thread.
+		 */
+		void end_reader_thread() {
+			if (!_reader) return;
+
+			_reader->b_run = false;
+			if (_reader->th.joinable()) _reader->th.join();
+
+			if (auto l = TWE::LockGuard(_mtx_rx)) {
+				_reader.reset();
+			}
+		}
+
+		/**
+		 * @fn	bool SerialCommon::is_reader_thread_running()
+		 *
+		 * @returns	True if the reader thread is running.
+		 */
+		bool is_reader_thread_running() {
+			return bool(_reader);
+		}
+
+		/**
+		 * @fn	bool SerialCommon::wait_rx(uint32_t timeout_ms)
+		 *
+		 * @brief	Blocks until the reader thread receives data or timeout.
+		 * 			If the reader thread is not running, just sleeps for timeout_ms.
+		 *
+		 * @param	timeout_ms	The timeout in milliseconds.
+		 *
+		 * @returns	True if data is received (or available), false if timeout.
+		 */
+		bool wait_rx(uint32_t timeout_ms) {
+			if (!_reader) {
+				if (timeout_ms > 0) delay(timeout_ms);
+				return available();
+			}
+
+			std::unique_lock<std::mutex> lk(_reader->mtx_notify);
+			_reader->cv_notify.wait_for(lk, std::chrono::milliseconds(timeout_ms), [this]() { return _reader->b_notified; });
+
+			bool r = _reader->b_notified;
+			_reader->b_notified = false;
+			return r;
+		}
+
+	private:
+		void _reader_thread_main() {
+			auto p = static_cast<CDER*>(this);
+
+			while (_reader->b_run) {
+				if (!_is_opened() || _que_free() == 0) {
+					// not opened or the queue is full (wait for the app loop, the driver keeps the data).
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					continue;
+				}
+
+				// block in the driver till data arrives (or timeout).
+				p->_wait_rx(_reader_context::WAIT_RX_MS);
+
+				int n = 0;
+				if (auto l = TWE::LockGuard(_mtx_rx)) {
+					if (_is_opened()) {
+						n = _update_span();
+						for (int i = 0; i < 2; i++) {
+							if (_span_rx.len[i] > 0) _reader->que_echo.push_force(_span_rx.p[i], uint16_t(_span_rx.len[i]));
+						}
+					}
+				}
+
+				if (n > 0) {
+					std::lock_guard<std::mutex> lk(_reader->mtx_notify);
+					_reader->b_notified = true;
+					_reader->cv_notify.notify_all();
+				}
+			}
+		}
+
+	protected:
+		/**
+		 * @fn	void SerialCommon::_wait_rx(int timeout_ms)
+		 *
+		 * @brief	Waits for incoming data in the driver (called from the reader thread).
+		 * 			Default implementation only sleeps shortly, drivers override it with
+		 * 			blocking API (poll(), event notification, ...).
+		 *
+		 * @param	timeout_ms	The timeout in milliseconds.
+		 */
+		void _wait_rx(int timeout_ms) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+	public:
+#endif
+
 		/**
 		 * @fn	TWEUTILS::SmplBuf_WChar& SerialCommon::query_extra_device_info()
 		 *
@@ -28,6 +28,13 @@ namespace TWE {
             , _idx_obj(-1)
         {}
 
+        ~SerialDuo() {
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+            // stop the reader thread here, it waits in _objC/_objD.
+            SUPER_SER::end_reader_thread();
+#endif
+        }
+
         // -1: not opened, 0:objC, 1:objD
         int get_cur_obj_id() {
             if (SUPER_SER::is_opened()) {
@@ -122,12 +129,12 @@ namespace TWE {
         int _update_this(T& obj) {
             int ret = -1;
             ret = obj.update();
-            SUPER_SER::_buf_len = obj._buf_len;
-            for (int i = 0; i < SUPER_SER::_buf_len; i++) {
-                SUPER_SER::_buf[i] = obj._buf[i];
-                SUPER_SER::_que.push(uint8_t(SUPER_SER::_buf[i]));
-            }
-            obj._que.clear();
+            auto span = obj.get_last_span();
+            SUPER_SER::_buf_len = span.size();
+            memcpy(SUPER_SER::_buf, span.p[0], span.len[0]);
+            memcpy(SUPER_SER::_buf + span.len[0], span.p[1], span.len[1]);
+            SUPER_SER::_que_push((const uint8_t*)SUPER_SER::_buf, SUPER_SER::_buf_len);
+            obj._que_clear();
             return ret;
         }
 
@@ -148,6 +155,26 @@ namespace TWE {
             return -1;
         }
 
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+        /**
+         * @fn	void SerialDuo::_wait_rx(int timeout_ms)
+         *
+         * @brief	waits in the active object (poll() of termios, FTDI event). (called from the reader thread)
+         *
+         * @param	timeout_ms	The timeout in milliseconds.
+         */
+        void _wait_rx(int timeout_ms) {
+            int idx = -1;
+            if (auto l = TWE::LockGuard(SUPER_SER::_mtx_rx)) {
+                if (SUPER_SER::_is_opened()) idx = _idx_obj;
+            }
+
+            if (idx == 0) _objC._wait_rx(timeout_ms);
+            else if (idx == 1) _objD._wait_rx(timeout_ms);
+            else SUPER_SER::_wait_rx(timeout_ms);
+        }
+#endif
+
         /**
          * @fn	TWEUTILS::SmplBuf_WChar& SerialDuo::query_extra_device_info()
          *
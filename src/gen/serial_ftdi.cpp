@@ -20,7 +20,9 @@ bool SerialFtdi::_set_baudrate(int baud) {
 			if (FT_W32_SetCommState(_ftHandle, &ftDCB)) return true;
 		}
 #else
-		FT_SetBaudRate(_ftHandle, ULONG(baud));
+		// FTDI driver calculates the divisor for arbitrary rate (e.g. up to 3Mbps with FT232R),
+		// returns FT_INVALID_BAUD_RATE if it cannot be achieved.
+		if (FT_SetBaudRate(_ftHandle, ULONG(baud)) != FT_OK) return false;
 		FT_SetDataCharacteristics(_ftHandle, FT_BITS_8, FT_STOP_BITS_1, FT_PARITY_NONE);
 
 		return true;
@@ -42,8 +44,9 @@ int SerialFtdi::_update() {
 		if (rxBytes >= sizeof(_buf)) {
 			rxBytes = sizeof(_buf);
 		}
-		if (rxBytes >= DWORD(_que.capacity() - _que.size())) {
-			rxBytes = DWORD(_que.capacity() - _que.size() - 1);
+		DWORD rxFree = DWORD(_que_free());
+		if (rxBytes > rxFree) {
+			rxBytes = rxFree;
 		}
 
 #if defined(USE_FT_W32_API)
@@ -58,9 +61,7 @@ int SerialFtdi::_update() {
 #endif
 
 		if (_ftStatus == FT_OK) {
-			for (DWORD i = 0; i < rxBytesReceived; i++) {
-				_que.push(uint8_t(_buf[i]));
-			}
+			_que_push((const uint8_t*)_buf, int(rxBytesReceived));
 
 			_buf_len = rxBytesReceived;
 			return _buf_len;
@@ -71,6 +72,50 @@ int SerialFtdi::_update() {
 }
 
 
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+void SerialFtdi::_wait_rx(int timeout_ms) {
+	DWORD rxBytes = 0;
+	bool b_handle = false;
+
+	// check the queue status (the handle may be closed by the app thread).
+	if (auto l = TWE::LockGuard(_mtx_rx)) {
+		if (_ftHandle != NULL) {
+			b_handle = true;
+			if (_ftHandleEvt != _ftHandle) {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+				FT_SetEventNotification(_ftHandle, FT_EVENT_RXCHAR, (PVOID)_hEvent);
+#else
+				FT_SetEventNotification(_ftHandle, FT_EVENT_RXCHAR, (PVOID)&_hEvent);
+#endif
+				_ftHandleEvt = _ftHandle;
+			}
+			FT_GetQueueStatus(_ftHandle, &rxBytes);
+		}
+	}
+
+	if (!b_handle) {
+		delay(timeout_ms);
+		return;
+	}
+	if (rxBytes > 0) return; // data is already there.
+
+	// wait for the event (if the event is fired just before waiting, it's handled at next timeout.)
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	WaitForSingleObject(_hEvent, DWORD(timeout_ms));
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_nsec += long(timeout_ms) * 1000000L;
+	ts.tv_sec += ts.tv_nsec / 1000000000L;
+	ts.tv_nsec %= 1000000000L;
+
+	pthread_mutex_lock(&_hEvent.eMutex);
+	pthread_cond_timedwait(&_hEvent.eCondVar, &_hEvent.eMutex, &ts);
+	pthread_mutex_unlock(&_hEvent.eMutex);
+#endif
+}
+#endif
+
 int SerialFtdi::_list_devices(bool append_entry) {
 	FT_STATUS ftStatus;
 	FT_HANDLE ftHandleTemp;
@@ -24,6 +24,15 @@ namespace TWE {
 		FT_HANDLE _ftHandle;
 		FT_DEVICE _ftDevice;
 
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+		FT_HANDLE _ftHandleEvt; // the handle which FT_SetEventNotification() is applied to.
+# if defined(_MSC_VER) || defined(__MINGW32__)
+		HANDLE _hEvent;
+# else
+		EVENT_HANDLE _hEvent;
+# endif
+#endif
+
 	public:
 		static const uint8_t BITBANG_MASK_PGM = 8;
 		static const uint8_t BITBANG_MASK_RST = 4;
@@ -39,7 +48,32 @@ namespace TWE {
 		 *
 		 * @param	bufsize	(Optional) The bufsize of internal queue.
 		 */
-		SerialFtdi(size_t bufsize = 2048) : SerialCommon(bufsize), _ftStatus{}, _ftHandle{}, _ftDevice{} {}
+		SerialFtdi(size_t bufsize = 2048) : SerialCommon(bufsize), _ftStatus{}, _ftHandle{}, _ftDevice{}
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			, _ftHandleEvt{}, _hEvent{}
+#endif
+		{
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+# if defined(_MSC_VER) || defined(__MINGW32__)
+			_hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+# else
+			pthread_mutex_init(&_hEvent.eMutex, NULL);
+			pthread_cond_init(&_hEvent.eCondVar, NULL);
+# endif
+#endif
+		}
+
+		~SerialFtdi() {
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			SUPER_SER::end_reader_thread();
+# if defined(_MSC_VER) || defined(__MINGW32__)
+			CloseHandle(_hEvent);
+# else
+			pthread_cond_destroy(&_hEvent.eCondVar);
+			pthread_mutex_destroy(&_hEvent.eMutex);
+# endif
+#endif
+		}
 
 	public: //TODO shou;ld be PRIVATE
 		/**
@@ -63,6 +97,16 @@ namespace TWE {
 		 */
 		int _update();
 
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+		/**
+		 * @fn	void SerialFtdi::_wait_rx(int timeout_ms);
+		 *
+		 * @brief	waits for FT_EVENT_RXCHAR notification. (called from the reader thread)
+		 *
+		 * @param	timeout_ms	The timeout in milliseconds.
+		 */
+		void _wait_rx(int timeout_ms);
+#endif
 
 		/**
 		 * @fn	int SerialFtdi::write(const uint8_t* p, int len)
@@ -134,6 +178,9 @@ namespace TWE {
 #endif
 
 				_ftHandle = NULL;
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+				_ftHandleEvt = NULL;
+#endif
 				_devname[0] = 0;
 			}
 		}
@@ -0,0 +1,319 @@
+#pragma once
+
+/* Copyright (C) 2020-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include "twe_common.hpp"
+#include "twe_sercmd_auto.hpp"
+#include "twe_fmt.hpp"
+
+#include "serial_common.hpp"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <cstring>
+
+namespace TWE {
+	/**
+	 * @class	SerialMulti
+	 *
+	 * @brief	Multiple serial ports opened at the same time (e.g. several parent devices on
+	 * 			different channels). Each port has its own serial object, parser and counters.
+	 * 			Decoded packets of all ports are merged into one stream ordered by the arrival tick,
+	 * 			and common.port of each packet tells the source port.
+	 *
+	 * 			Port 0 is the primary port (Serial2) which is read by the app, the app passes
+	 * 			the bytes by feed(0, ...). Other ports (1..) are opened by open() and read by update().
+	 *
+	 * @tparam	SER	serial class (SerialCommon derived).
+	 */
+	template <class SER>
+	class SerialMulti {
+	public:
+		static const int PORT_MAX = SerialPortEntries::SERPORT_ENT_MAX;
+		static const int QUE_MAX = 256; // max packets pending per port
+		static const uint32_t BAUD_DEFAULT = 115200; // the rate of Serial2 (port 0)
+
+		/**
+		 * @struct	port_stats
+		 *
+		 * @brief	counters of a port (see get_port_stats()).
+		 */
+		struct port_stats {
+			uint32_t u32pkts;      // packets decoded
+			uint32_t u32dropped;   // packets dropped as nobody popped them
+			uint32_t u32dup;       // copies suppressed by set_dedup() (not decoded)
+			TWESERCMD::ParserStats parser; // frames completed/errored
+		};
+
+	private:
+		struct _port {
+			std::unique_ptr<SER> ser; // nullptr for port 0
+			TWESERCMD::AutoParserT<512> parser; // ASCII and binary frames
+			std::deque<TWEFMT::spTwePacket> que; // decoded packets (in order of arrival)
+			uint32_t u32pkts;
+			uint32_t u32dropped;
+			uint32_t u32dup;
+
+			_port() : ser(), parser(), que(), u32pkts(0), u32dropped(0), u32dup(0) {}
+		};
+
+		std::vector<std::unique_ptr<_port>> _ports; // [0] is the primary port.
+		TWEFMT::PacketDedup* _dedup; // duplicate suppression (optional)
+		std::function<const char*()> _fn_devname_primary; // devname opened by port 0 (see set_primary())
+
+		// true if tick a is earlier than b (allowing wrap around)
+		static inline bool _is_before(uint32_t a, uint32_t b) {
+			return int32_t(a - b) < 0;
+		}
+
+	public:
+		SerialMulti() : _ports(), _dedup(nullptr), _fn_devname_primary() {
+			_ports.emplace_back(new _port());
+		}
+
+		~SerialMulti() {
+			close_all();
+		}
+
+		/**
+		 * @fn	template <class S> void SerialMulti::set_primary(S& ser)
+		 *
+		 * @brief	Sets the serial object of port 0 (Serial2), open() rejects the device opened by it.
+		 *
+		 * @param	ser	the serial object of port 0 (should live longer than this object).
+		 */
+		template <class S>
+		void set_primary(S& ser) {
+			_fn_devname_primary = [&ser]() -> const char* { return ser.is_opened() ? ser.get_devname() : nullptr; };
+		}
+
+		/**
+		 * @fn	bool SerialMulti::is_in_use(const char* devname)
+		 *
+		 * @brief	true if the device is opened by port 0 or an additional port.
+		 */
+		bool is_in_use(const char* devname) {
+			const char* d0 = _fn_devname_primary ? _fn_devname_primary() : nullptr;
+			if (d0 && !strcmp(d0, devname)) return true;
+
+			for (auto& p : _ports) {
+				if (p->ser && p->ser->is_opened() && !strcmp(p->ser->get_devname(), devname)) return true;
+			}
+			return false;
+		}
+
+		/**
+		 * @fn	int SerialMulti::open(const char* devname, uint32_t baud)
+		 *
+		 * @brief	Opens an additional port.
+		 *
+		 * @param	devname	The device name (see SerialPortEntries::ser_devname).
+		 * @param	baud   	The baud rate (the same as Serial2 by default).
+		 *
+		 * @returns	port index (1..), -1: error (or the device is already opened).
+		 */
+		int open(const char* devname, uint32_t baud = BAUD_DEFAULT) {
+			if (int(_ports.size()) >= PORT_MAX + 1) return -1;
+			if (devname == nullptr || is_in_use(devname)) return -1;
+
+			std::unique_ptr<_port> p(new _port());
+			p->ser.reset(new SER());
+
+			if (!p->ser->open(devname)) return -1;
+			p->ser->begin(baud);
+
+			_ports.push_back(std::move(p));
+			return int(_ports.size()) - 1;
+		}
+
+		/**
+		 * @fn	void SerialMulti::close_all()
+		 *
+		 * @brief	Closes all additional ports.
+		 */
+		void close_all() {
+			end_reader_threads();
+			for (auto& p : _ports) {
+				if (p->ser) p->ser->close();
+			}
+			_ports.resize(1);
+		}
+
+		/**
+		 * @fn	int SerialMulti::count()
+		 *
+		 * @brief	number of additional ports.
+		 */
+		int count() {
+			return int(_ports.size()) - 1;
+		}
+
+		/**
+		 * @fn	SER* SerialMulti::get_serial(int port)
+		 *
+		 * @brief	Gets the serial object of the port (e.g. writing a command).
+		 *
+		 * @returns	the serial object, nullptr for port 0 or invalid index.
+		 */
+		SER* get_serial(int port) {
+			return (port > 0 && port < int(_ports.size())) ? _ports[port]->ser.get() : nullptr;
+		}
+
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+		/**
+		 * @fn	void SerialMulti::begin_reader_threads()
+		 *
+		 * @brief	starts reader threads of additional ports.
+		 */
+		void begin_reader_threads() {
+			for (auto& p : _ports) {
+				if (p->ser) p->ser->begin_reader_thread();
+			}
+		}
+#endif
+
+		/**
+		 * @fn	void SerialMulti::end_reader_threads()
+		 *
+		 * @brief	stops reader threads of additional ports.
+		 */
+		void end_reader_threads() {
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			for (auto& p : _ports) {
+				if (p->ser) p->ser->end_reader_thread();
+			}
+#endif
+		}
+
+		/**
+		 * @fn	int SerialMulti::update()
+		 *
+		 * @brief	Reads additional ports and decodes packets.
+		 *
+		 * @returns	number of bytes read.
+		 */
+		int update() {
+			uint8_t buf[256];
+			int total = 0;
+
+			for (int i = 1; i < int(_ports.size()); i++) {
+				auto& ser = *_ports[i]->ser;
+				ser.update();
+
+				int len;
+				uint32_t tick;
+				while (0 < (len = ser.read(buf, sizeof(buf), tick))) {
+					feed(i, buf, len, tick);
+					total += len;
+				}
+			}
+
+			return total;
+		}
+
+		/**
+		 * @fn	void SerialMulti::set_dedup(TWEFMT::PacketDedup* dedup)
+		 *
+		 * @brief	Sets the duplicate suppression stage, the copies of a packet received
+		 * 			via repeaters or by other ports are dropped before decoding.
+		 * 			Not set by default (all packets are passed), the apps set it if enabled by the settings.
+		 *
+		 * @param	dedup	the cache (owned by the caller), nullptr to disable.
+		 */
+		void set_dedup(TWEFMT::PacketDedup* dedup) {
+			_dedup = dedup;
+		}
+
+		/**
+		 * @fn	void SerialMulti::feed(int port, const uint8_t* p, int len, uint32_t tick)
+		 *
+		 * @brief	Passes received bytes of the port to its parser.
+		 *
+		 * @param	port	port index.
+		 * @param	p   	received bytes.
+		 * @param	len 	length of them.
+		 * @param	tick	arrival tick of them (0: unknown).
+		 */
+		void feed(int port, const uint8_t* p, int len, uint32_t tick) {
+			if (port < 0 || port >= int(_ports.size())) return;
+			auto& pt = *_ports[port];
+
+			pt.parser.set_tick(tick);
+			pt.parser.parse(p, size_t(len), [this, &pt, port](TWESERCMD::AutoParser& ps) {
+				if (_dedup && !_dedup->accept(ps)) {
+					pt.u32dup++;
+					return;
+				}
+
+				auto pkt = TWEFMT::newTwePacket(ps);
+				if (TWEFMT::identify_packet_type(pkt) != TWEFMT::E_PKT::PKT_ERROR) {
+					pkt->common.port = uint8_t(port);
+					pt.u32pkts++;
+
+					if (pt.que.size() >= QUE_MAX) {
+						pt.que.pop_front(); // too many (nobody pops), remove the oldest.
+						pt.u32dropped++;
+					}
+					pt.que.push_back(pkt);
+				}
+			});
+		}
+
+		/**
+		 * @fn	bool SerialMulti::available()
+		 *
+		 * @brief	true if any decoded packet is pending.
+		 */
+		bool available() {
+			for (auto& p : _ports) {
+				if (!p->que.empty()) return true;
+			}
+			return false;
+		}
+
+		/**
+		 * @fn	TWEFMT::spTwePacket SerialMulti::pop()
+		 *
+		 * @brief	Pops the earliest packet of all ports.
+		 *
+		 * @returns	the packet, empty pointer if nothing is pending.
+		 */
+		TWEFMT::spTwePacket pop() {
+			_port* pmin = nullptr;
+
+			for (auto& p : _ports) {
+				if (p->que.empty()) continue;
+				if (pmin == nullptr || _is_before(p->que.front()->common.tick, pmin->que.front()->common.tick)) {
+					pmin = p.get();
+				}
+			}
+
+			TWEFMT::spTwePacket pkt;
+			if (pmin) {
+				pkt = pmin->que.front();
+				pmin->que.pop_front();
+			}
+			return pkt;
+		}
+
+		/**
+		 * @fn	port_stats SerialMulti::get_port_stats(int port)
+		 *
+		 * @brief	Gets the counters of the port. (see also get_serial()->get_rx_stats())
+		 */
+		port_stats get_port_stats(int port) {
+			port_stats s = port_stats();
+			if (port >= 0 && port < int(_ports.size())) {
+				auto& pt = *_ports[port];
+				s.u32pkts = pt.u32pkts;
+				s.u32dropped = pt.u32dropped;
+				s.u32dup = pt.u32dup;
+				s.parser = pt.parser.get_stats();
+			}
+			return s;
+		}
+	};
+}
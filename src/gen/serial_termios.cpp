@@ -5,9 +5,106 @@
 
 #include "serial_termios.hpp"
 #include <filesystem>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+
+#if defined(__linux)
+// struct termios2 of the kernel (asm-generic layout), which is not exposed by glibc's <termios.h>.
+// it's used with TCGETS2/TCSETS2 to set arbitrary baud rate (BOTHER).
+struct termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+# ifndef BOTHER
+#  define BOTHER 0010000
+# endif
+#elif defined(__APPLE__)
+# include <IOKit/serial/ioss.h> // IOSSIOSPEED
+#endif
 
 using namespace TWE;
 
+/**
+ * @fn	static speed_t s_baud_to_speed(int baud)
+ *
+ * @brief	Converts baud rate into termios speed constant.
+ *
+ * @param	baud	The baud.
+ *
+ * @returns	Bxxx constant, B0 if it's not a standard one.
+ */
+static speed_t s_baud_to_speed(int baud) {
+    switch(baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B500000
+        case 500000: return B500000;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+#ifdef B3000000
+        case 3000000: return B3000000;
+#endif
+        default: return B0;
+    }
+}
+
+/**
+ * @fn	static bool s_set_baud_other(int fd, int baud)
+ *
+ * @brief	Sets non-standard baud rate (termios2/BOTHER on Linux, IOSSIOSPEED on macOS).
+ * 			The other settings must be done by tcsetattr() in advance.
+ *
+ * @param	fd  	The file descriptor.
+ * @param	baud	The baud.
+ *
+ * @returns	True if the driver accepts the rate (within 3% of the request).
+ */
+static bool s_set_baud_other(int fd, int baud) {
+#if defined(__linux) && defined(TCGETS2)
+    struct termios2 tio2;
+    if (::ioctl(fd, TCGETS2, &tio2) != 0) return false;
+
+    tio2.c_cflag &= ~CBAUD;
+    tio2.c_cflag |= BOTHER;
+    tio2.c_ispeed = speed_t(baud);
+    tio2.c_ospeed = speed_t(baud);
+    if (::ioctl(fd, TCSETS2, &tio2) != 0) return false;
+
+    // read back, the driver may round the rate to its clock.
+    if (::ioctl(fd, TCGETS2, &tio2) != 0) return false;
+    int actual = int(tio2.c_ospeed);
+    int diff = actual > baud ? actual - baud : baud - actual;
+    return diff * 100 <= baud * 3;
+#elif defined(__APPLE__) && defined(IOSSIOSPEED)
+    speed_t spd = speed_t(baud);
+    return ::ioctl(fd, IOSSIOSPEED, &spd) == 0;
+#else
+    return false;
+#endif
+}
+
 bool SerialTermios::_open(const char* devname) {
     if (devname != nullptr) {
         char devname_full[128];
@@ -29,28 +126,22 @@ bool SerialTermios::_open(const char* devname) {
 }
 
 bool SerialTermios::_set_baudrate(int baud) {
-    if (is_opened()) {
+    if (is_opened() && baud > 0) {
         ::tcgetattr(_fd, &_options);
 
-        switch(baud) {
-            case 9600: _options.c_cflag = B9600; break;
-            case 19200: _options.c_cflag = B19200; break;
-            case 38400: _options.c_cflag = B38400; break;
-            case 57600: _options.c_cflag = B57600; break;
-            case 115200: _options.c_cflag = B115200; break;
-            case 230400: _options.c_cflag = B230400; break;
-            case 500000: _options.c_cflag = B500000; break;
-            case 1000000: _options.c_cflag = B1000000; break;
-            default: return false;
-        }
+        speed_t spd = s_baud_to_speed(baud);
+        bool b_other = (spd == B0); // not a standard rate, set it later.
 
-        _options.c_cflag |= CS8 | CLOCAL | CREAD;
+        _options.c_cflag = CS8 | CLOCAL | CREAD;
         _options.c_iflag = 0; // no translation of CR/NLs.
         _options.c_oflag = 0;
         _options.c_lflag = 0;
+        ::cfsetispeed(&_options, b_other ? B38400 : spd);
+        ::cfsetospeed(&_options, b_other ? B38400 : spd);
         ::tcflush(_fd, TCIFLUSH);
-        ::tcsetattr(_fd, TCSANOW, &_options);
+        if (::tcsetattr(_fd, TCSANOW, &_options) != 0) return false;
 
+        if (b_other) return s_set_baud_other(_fd, baud);
         return true;
     } else {
         return false;
@@ -59,17 +150,27 @@ bool SerialTermios::_set_baudrate(int baud) {
 
 int SerialTermios::_update() {
 	if (is_opened()) {
-        int rxBytesMax = _que.capacity() - _que.size() - 1;
+        uint8_t *p1, *p2;
+        int n1, n2;
 		_buf_len = 0;
 
-        // read it to _buf[]
-        int rxLength = ::read(_fd, (void*)_buf, rxBytesMax);
+        // read directly into the free region of the queue (two spans if wrapped around).
+        if (_que_free_spans(p1, n1, p2, n2) == 0) return 0;
+
+        struct iovec iov[2];
+        iov[0].iov_base = p1;
+        iov[0].iov_len = n1;
+        iov[1].iov_base = p2;
+        iov[1].iov_len = n2;
+
+        int rxLength = (int)::readv(_fd, iov, n2 > 0 ? 2 : 1);
 
         if (rxLength > 0) {
-            // push into internal queue
-            for(int i = 0; i < rxLength; i++) {
-                _que.push(uint8_t(_buf[i]));
-            }
+            _que_commit(rxLength);
+
+            // the received range (for console/logging)
+            int l1 = rxLength < n1 ? rxLength : n1;
+            _span_rx = SerialRxSpan(p1, l1, p2, rxLength - l1);
 
             _buf_len = rxLength;
             return _buf_len;
@@ -79,6 +180,33 @@ int SerialTermios::_update() {
 	return 0;
 }
 
+void SerialTermios::_wait_rx(int timeout_ms) {
+    // the fd may be closed (and its number reused) by the app thread,
+    // so poll() a duplicate of it taken under the lock.
+    int fd = -1;
+    if (auto l = TWE::LockGuard(_mtx_rx)) {
+        if (_fd >= 0) fd = ::dup(_fd);
+    }
+
+    if (fd < 0) {
+        delay(timeout_ms);
+        return;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int r = ::poll(&pfd, 1, timeout_ms);
+    ::close(fd);
+
+    if (r < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        // the device is not available (e.g. unplugged), avoid busy loop.
+        delay(timeout_ms);
+    }
+}
+
 /**
  * @fn	static int SerialFtdi::list_devices()
  *
@@ -25,6 +25,13 @@ namespace TWE {
     public:
         SerialTermios(size_t bufsize = 2048) : SerialCommon(bufsize), _fd(-1), _options() {}
 
+		~SerialTermios() {
+#if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1
+			// stop the reader thread here, before the members (_fd) are destroyed.
+			SUPER_SER::end_reader_thread();
+#endif
+		}
+
 	private:
         bool _open(const char* devname);
 
@@ -41,10 +48,11 @@ namespace TWE {
 		 * @fn	bool SerialFtdi::set_baudrate(int baud);
 		 *
 		 * @brief	Sets a baudrate
+		 * 			Non-standard rates are set by termios2/BOTHER (Linux) or IOSSIOSPEED (macOS).
 		 *
 		 * @param	baud	The baud.
 		 *
-		 * @returns	True if it succeeds, false if it fails.
+		 * @returns	True if it succeeds, false if it fails (the driver does not accept the rate).
 		 */
         bool _set_baudrate(int baud);
 
@@ -78,6 +86,15 @@ namespace TWE {
 		 */
 		int _update();
 
+		/**
+		 * @fn	void SerialTermios::_wait_rx(int timeout_ms)
+		 *
+		 * @brief	blocks in poll() until the fd gets readable. (called from the reader thread)
+		 *
+		 * @param	timeout_ms	The timeout in milliseconds.
+		 */
+		void _wait_rx(int timeout_ms);
+
 		/**
 		 * @fn	TWEUTILS::SmplBuf_WChar& SerialTermios::_query_extra_deviceinfo()
 		 *
@@ -11,6 +11,7 @@
 #include "serial_termios.hpp"
 #include "serial_duo.hpp"
 #include "serial_srv_pipe.hpp"
+#include "serial_multi.hpp"
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
 #include "../win/msc_term.hpp"
@@ -75,6 +76,14 @@ namespace TWE {
 #	else
 	extern TWE::TWE_PutChar_Serial<TWE::SerialFtdi> WrtTWE;
 #	endif
+#endif
+
+	/**
+	 * @brief	Additional ports opened at the same time as Serial2 (needs FTDI driver).
+	 */
+#if !(defined(__APPLE__) && (defined(MWM5_SERIAL_NO_FTDI) || defined(MWM5_SERIAL_DUMMY)))
+#	define MWM5_SERIAL_MULTI 1
+	extern TWE::SerialMulti<TWE::SerialFtdi> the_serial_multi;
 #endif
 }
 
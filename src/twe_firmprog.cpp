@@ -134,6 +134,7 @@ TweProg::E_ST_TWEBLP TweProg::next_state() {
 
 void TweProg::error_state() {
 	_state = E_ST_TWEBLP::FINISH_ERROR;
+	_bl->set_timeout();
 	_bl->change_baud(_bl->get_baud_default());
 	_bl->reset_module();
 }
@@ -166,27 +167,24 @@ bool TweProg::process_input(int c) {
 	bool bcomp = _bl->receive(c); // handle protocol
 
 	if (bcomp) {
+		// EVENT_ERROR fails the state, unless the state handles it (e.g. CONNECT).
 		auto rcvstat = _bl->get_receive_status();
-		if (rcvstat == ITweBlProtocol::RESP_STAT_COMPLETED) {
-			switch (process_body(EVENT_RESPOND)) {
-			case PROCESS_SUCCESS:
-				next_state();
-				if (_state == E_ST_TWEBLP::FINISH || _state == E_ST_TWEBLP::FINISH_ERROR) {
-					bexit = true;
-				}
-				else {
-					bexit = false;
-				}
-				break;
-			case PROCESS_CONT:
-				bexit = false;
-				break;
-			default:
-				error_state();
+		int evt = (rcvstat == ITweBlProtocol::RESP_STAT_COMPLETED) ? EVENT_RESPOND : EVENT_ERROR;
+
+		switch (process_body(evt)) {
+		case PROCESS_SUCCESS:
+			next_state();
+			if (_state == E_ST_TWEBLP::FINISH || _state == E_ST_TWEBLP::FINISH_ERROR) {
 				bexit = true;
 			}
-		} else {
-			// error
+			else {
+				bexit = false;
+			}
+			break;
+		case PROCESS_CONT:
+			bexit = false;
+			break;
+		default:
 			error_state();
 			bexit = true;
 		}
@@ -208,6 +206,7 @@ bool TweProg::process_input(int c) {
  * 				EVENT_NEW_STATE : start the state
  * 				EVENT_RESPOND   : has response
  * 				EVENT_PROCESS   : wait more response keeping the state
+ * 				EVENT_ERROR     : no valid response
  *
  * @returns	0:error, 1:success, 2:wait more response
  */
@@ -217,18 +216,16 @@ int TweProg::process_body(int c) {
 #if defined(ESP32)
 	//uint8_t U8_BAUD_DIV = 3; // The limit of Serial2 (HardwareSerial)
 	const uint8_t U8_BAUD_DIV = 2; // 1Mbps works with Serial2_IDF, however speed is not so fast, so 500kbps is good compromization.
-	const uint32_t U32_BAUD = (1000000UL / U8_BAUD_DIV);
 #elif defined(MWM5_BUILD_RASPI) // maybe ok with 1Mbps
 	const uint8_t U8_BAUD_DIV = 2; 
-	const uint32_t U32_BAUD = (1000000UL / U8_BAUD_DIV);
 #elif defined(_MSC_VER) || defined(__APPLE__) || defined(__linux) || defined(__MINGW32__)
 	const uint8_t U8_BAUD_DIV = 1;
-	const uint32_t U32_BAUD = (1000000UL / U8_BAUD_DIV);
 #endif
+	const uint8_t U8_BAUD_DIV_MAX = 4; // the slowest candidate of fast mode (250kbps)
 
 	switch (_state) {
 	case E_ST_TWEBLP::CONNECT:
-		// change baud rate higher
+		// change baud rate higher, the fastest rate (1Mbps/div) which the host serial and the module can do.
 		if (c == EVENT_NEW_STATE) {
 #if 0	// force safe baud (if modctl is unabled)
 			if (!_bl->get_modctl_enabled()) {
@@ -237,23 +234,68 @@ int TweProg::process_body(int c) {
 			} else
 #endif
 			{
-				// set fast mode
-				if (!_bl->request(0x27, 0x28, U8_BAUD_DIV)) {
-					error_state();
-					ret = PROCESS_FAIL;
-				}
-				else ret = PROCESS_SUCCESS;
+				_baud_neg.n = 0;
+				_baud_neg.idx = 0;
+				for (uint8_t d = U8_BAUD_DIV; d <= U8_BAUD_DIV_MAX; d++) _baud_neg.rates[_baud_neg.n++] = 1000000UL / d;
+				_bl->set_baud_prog(ITweBlProtocol::BAUD_PROG_SAFE);
+
+				// if the host serial cannot do any of them, keep the safe baud rate.
+				ret = baud_neg_request() ? PROCESS_SUCCESS : PROCESS_SKIP;
 			}
 
 			if (_protocol_cb) _protocol_cb(E_ST_TWEBLP::CONNECT, EVENT_NEW_STATE, ret, _bl->get_command_buf(), _pobj);
 		} else
-		if (c == EVENT_RESPOND) {
-			// change baud
-			_bl->change_baud(U32_BAUD);
-			delay(50);
+		if (c == EVENT_RESPOND || c == EVENT_ERROR) {
+			uint32_t baud = _baud_neg.rates[_baud_neg.idx];
+			bool b_next = false; // try the next candidate
+
+			switch (_baud_neg.st) {
+			case sBaudNeg::E_ST::SET_BAUD:
+				if (c == EVENT_RESPOND) {
+					// the module is switched, read chip ID at the rate.
+					_bl->change_baud(baud);
+					_bl->request(0x32, 0x33);
+					_baud_neg.st = sBaudNeg::E_ST::CHECK_BAUD;
+					ret = PROCESS_CONT;
+				}
+				else {
+					(void)_bl->restart_prog();
+					b_next = true;
+				}
+				break;
+
+			case sBaudNeg::E_ST::CHECK_BAUD:
+				if (c == EVENT_RESPOND) {
+					_bl->set_baud_prog(baud);
+					ret = PROCESS_SUCCESS;
+				}
+				else if (_bl->restart_prog()) {
+					b_next = true;
+				}
+				else {
+					// w/o modctl, set baud command at the rate (1Mbps/26 = 38461bps, +0.16%)
+					_bl->request(0x27, 0x28, uint8_t(1000000UL / ITweBlProtocol::BAUD_PROG_SAFE));
+					_baud_neg.st = sBaudNeg::E_ST::RESTORE_BAUD;
+					ret = PROCESS_CONT;
+				}
+				break;
 
-			ret = PROCESS_SUCCESS;
-			if (_protocol_cb) _protocol_cb(E_ST_TWEBLP::CONNECT, EVENT_RESPOND, ret, _bl->get_response_buf(), _pobj);
+			case sBaudNeg::E_ST::RESTORE_BAUD:
+				_bl->change_baud(ITweBlProtocol::BAUD_PROG_SAFE);
+				b_next = true;
+				break;
+			}
+
+			if (b_next) {
+				// if no more candidate, go to the next state at the safe baud rate.
+				_baud_neg.idx++;
+				ret = baud_neg_request() ? PROCESS_CONT : PROCESS_SUCCESS;
+			}
+
+			if (ret == PROCESS_SUCCESS) {
+				_bl->set_timeout();
+				if (_protocol_cb) _protocol_cb(E_ST_TWEBLP::CONNECT, EVENT_RESPOND, ret, _bl->get_response_buf(), _pobj);
+			}
 		}
 		break;
 
@@ -566,4 +608,28 @@ int TweProg::process_body(int c) {
 	}
 
 	return ret;
-}
\ No newline at end of file
+}
+
+/**
+ * @fn	bool TweProg::baud_neg_request()
+ *
+ * @brief	Sends the set baud command (at BAUD_PROG_SAFE) of the current candidate
+ * 			(_baud_neg.idx), the candidates which the host serial cannot do are skipped.
+ *
+ * @returns	false if no more candidate.
+ */
+bool TweProg::baud_neg_request() {
+	const uint32_t TIM_RESP_BAUD = 200; // [ms]
+
+	for (; _baud_neg.idx < _baud_neg.n; _baud_neg.idx++) {
+		uint32_t baud = _baud_neg.rates[_baud_neg.idx];
+		if (!_bl->test_baud(baud)) continue; // the host serial cannot do it.
+
+		_baud_neg.st = sBaudNeg::E_ST::SET_BAUD;
+		_bl->set_timeout(TIM_RESP_BAUD);
+		return _bl->request(0x27, 0x28, uint8_t(1000000UL / baud));
+	}
+
+	_bl->set_timeout();
+	return false;
+}
@@ -28,10 +28,12 @@ namespace TWE {
 		static const uint32_t BAUD_PROG_SAFE = 38400;
 		static const uint32_t BAUD_APP_STANDARD = 115200;
 
+		static const uint32_t TIM_RESP_DEFAULT = 1000;
+
 	public:
 		ITweBlProtocol() :
 			_arg_buf(256), _resp_buf(256), _resp_id(0), _resp_id_expected(0),
-			_tim_start(0), _tim_timeout(1000), _resp_state(0),
+			_tim_start(0), _tim_timeout(TIM_RESP_DEFAULT), _resp_state(0),
 			_baud_default(BAUD_APP_STANDARD), _baud_prog(BAUD_PROG_SAFE) {}
 		virtual ~ITweBlProtocol() {}
 
@@ -45,6 +47,8 @@ namespace TWE {
 		virtual void serial_write(const char * str, int len) = 0;
 		virtual bool connect() = 0;
 		virtual bool change_baud(int i) = 0;
+		virtual bool test_baud(uint32_t baud) = 0; // checks if the host serial can do the rate (kept at BAUD_PROG_SAFE).
+		virtual bool restart_prog() = 0; // puts the module into PROGRAM MODE at BAUD_PROG_SAFE again (false if no modctl).
 		virtual bool reset_module() = 0;
 		virtual bool hold_reset_pin() = 0;
 		virtual bool setpin(bool bSet) = 0;
@@ -72,6 +76,10 @@ namespace TWE {
 			return _resp_state;
 		}
 
+		inline void set_timeout(uint32_t tim_ms = TIM_RESP_DEFAULT) {
+			_tim_timeout = tim_ms;
+		}
+
 	private:
 		bool request_body(int8_t id_req, uint8_t id_resp);
 	
@@ -127,6 +135,8 @@ namespace TWE {
 	public:
 		bool set_baud_default(uint32_t baud) { _baud_default = baud; return true; }
 		uint32_t get_baud_default() { return _baud_default; }
+		bool set_baud_prog(uint32_t baud) { _baud_prog = baud; return true; }
+		uint32_t get_baud_prog() { return _baud_prog; }
 	};
 
 	/**
@@ -186,6 +196,45 @@ namespace TWE {
 			return true;
 		}
 
+		/**
+		 * @fn	bool TweBlProtocol::test_baud(uint32_t baud)
+		 *
+		 * @brief	Checks if the host serial can do the rate.
+		 * 			The host serial is set back to BAUD_PROG_SAFE.
+		 *
+		 * @param	baud	the rate.
+		 *
+		 * @returns	true if the driver accepts the rate.
+		 */
+		bool test_baud(uint32_t baud) {
+#ifndef ESP32
+			_ser.flush();
+			bool b_ok = _ser.set_baudrate(int(baud));
+			_ser.set_baudrate(int(BAUD_PROG_SAFE));
+			return b_ok;
+#else
+			return true;
+#endif
+		}
+
+		/**
+		 * @fn	bool TweBlProtocol::restart_prog()
+		 *
+		 * @brief	Puts the module into PROGRAM MODE again, the module and the host serial
+		 * 			are back to BAUD_PROG_SAFE.
+		 *
+		 * @returns	false if the module control is not available.
+		 */
+		bool restart_prog() {
+			if (!_b_modctl_enabled) return false;
+
+			_ser.begin(BAUD_PROG_SAFE);
+			_modc.prog();
+			_discard_readbuffer();
+
+			return true;
+		}
+
 		bool connect() {
 			if (_b_modctl_enabled) {
 				// can control module (set BAUD and reset module)
@@ -269,6 +318,7 @@ namespace TWE {
 		static const int EVENT_NEW_STATE = 0;
 		static const int EVENT_RESPOND = 1;
 		static const int EVENT_PROCEED = 2;
+		static const int EVENT_ERROR = 3; // no valid response (time out, crc error, etc.)
 
 		static const int PROCESS_FAIL = 0;
 		static const int PROCESS_SUCCESS = 1;
@@ -312,6 +362,27 @@ namespace TWE {
 
 		volatile uint8_t _u8protocol_busy;
 
+		/**
+		 * @struct	sBaudNeg
+		 *
+		 * @brief	sub states of CONNECT, negotiating the rate of firmware writing.
+		 */
+		struct sBaudNeg {
+			enum class E_ST : uint8_t {
+				SET_BAUD = 0,	// set baud command (0x27) at BAUD_PROG_SAFE
+				CHECK_BAUD,		// read chip ID (0x32) at the candidate rate
+				RESTORE_BAUD	// set baud command at the candidate rate, back to BAUD_PROG_SAFE (w/o modctl)
+			};
+
+			static const int N_RATES = 4;
+			uint32_t rates[N_RATES]; // candidates (highest first)
+			uint8_t n;
+			uint8_t idx;
+			E_ST st;
+
+			sBaudNeg() : rates(), n(0), idx(0), st(E_ST::SET_BAUD) {}
+		} _baud_neg;
+
 	private:
 		/* private member funcs */
 		void set_state(E_ST_TWEBLP s) { _state = s; }
@@ -322,6 +393,8 @@ namespace TWE {
 
 		int process_body(int c);
 
+		bool baud_neg_request();
+
 	public:
 
 		/**
@@ -8,6 +8,112 @@
 using namespace TWEFMT;
 using namespace TWEUTILS;
 
+template <class T>
+inline spTwePacket _newTwePacket_parse(uint8_t* p, uint16_t u16len) {
+	spTwePacket sp = make_pooled_packet<T>(); // from the pool (no heap allocation in the steady state)
+	sp->parse(p, u16len);
+	return sp;
+}
+
+// identify() then parse(), for the packet types which have only a few header bytes to identify.
+template <class T>
+static spTwePacket _decode_generic(uint8_t* p, uint16_t u16len, E_PKT_ERR& err) {
+	if (T::identify(p, p + u16len, u16len) == E_PKT::PKT_ERROR) {
+		err = E_PKT_ERR::UNKNOWN;
+		return spTwePacket();
+	}
+	err = E_PKT_ERR::NONE;
+	return _newTwePacket_parse<T>(p, u16len);
+}
+
+// PAL is validated (sensor data length and CRC8) and decoded in a single pass by TwePacketPal::decode().
+static spTwePacket _decode_pal(uint8_t* p, uint16_t u16len, E_PKT_ERR& err) {
+	if (!TwePacketPal::identify_header(p, u16len)) {
+		err = E_PKT_ERR::UNKNOWN;
+		return spTwePacket();
+	}
+
+	auto sp = make_pooled_packet<TwePacketPal>();
+	err = sp->decode(p, u16len);
+	if (err == E_PKT_ERR::NONE || err == E_PKT_ERR::PAL_DATA) return sp; // accepted as PAL
+	return spTwePacket();
+}
+
+/**
+ * @class	_PacketClassifier
+ *
+ * @brief	Dispatch table of the packet families keyed by p[1] (command byte).
+ * 			Each key has a bitmap of the candidates (lower bit has higher priority),
+ * 			so a payload is checked only by the families which can match it.
+ */
+class _PacketClassifier {
+public:
+	static const int MAX_FAMILIES = 32;
+
+private:
+	PacketFamily _fam[MAX_FAMILIES];
+	int _n_fam;
+	uint32_t _cand[256]; // candidates by p[1]
+	uint32_t _cand_any;  // candidates for the payload shorter than 2 bytes (key is -1)
+
+public:
+	_PacketClassifier() : _fam(), _n_fam(0), _cand(), _cand_any(0) {
+		// the same order as the former sequential identify() calls.
+		add({ E_PKT::PKT_PAL,     -1,   0,  TwePacketPal::identify,     _decode_pal });                       // TWELITE PAL
+		add({ E_PKT::PKT_TWELITE, 0x81, 23, TwePacketTwelite::identify, _decode_generic<TwePacketTwelite> }); // App Twelite 0x81 command
+		add({ E_PKT::PKT_APPIO,   0x81, 20, TwePacketAppIO::identify,   _decode_generic<TwePacketAppIO> });   // App IO 0x81
+		add({ E_PKT::PKT_APPUART, 0xA0, 0,  TwePacketAppUART::identify, _decode_generic<TwePacketAppUART> }); // App UART
+		add({ E_PKT::PKT_ACT_STD, 0xAA, 0,  TwePacketActStd::identify,  _decode_generic<TwePacketActStd> });  // Act standard
+		add({ E_PKT::PKT_APPTAG,  -1,   0,  TwePacketAppTAG::identify,  _decode_generic<TwePacketAppTAG> });  // Act TAG
+	}
+
+	bool add(const PacketFamily& fam) {
+		if (_n_fam >= MAX_FAMILIES || fam.identify == nullptr || fam.decode == nullptr) return false;
+
+		uint32_t bit = 1UL << _n_fam;
+		_fam[_n_fam++] = fam;
+
+		if (fam.key < 0) {
+			for (auto& c : _cand) c |= bit;
+			_cand_any |= bit;
+		}
+		else {
+			_cand[fam.key & 0xFF] |= bit;
+		}
+		return true;
+	}
+
+	// candidates of the payload
+	inline uint32_t candidates(uint8_t* p, uint16_t u16len) const {
+		return u16len >= 2 ? _cand[p[1]] : _cand_any;
+	}
+
+	// the family of bit i, nullptr if the fixed length does not match.
+	inline const PacketFamily* family(int i, uint16_t u16len) const {
+		const PacketFamily& fam = _fam[i];
+		return (fam.len == 0 || fam.len == u16len) ? &fam : nullptr;
+	}
+};
+
+static _PacketClassifier& _the_classifier() {
+	static _PacketClassifier c;
+	return c;
+}
+
+/**
+ * @fn	bool TWEFMT::register_packet_family(const PacketFamily& fam)
+ *
+ * @brief	Adds a packet family to the classifier with the lowest priority.
+ * 			It is not thread safe, call it before receiving packets.
+ *
+ * @param	fam	the entry.
+ *
+ * @returns	True if it succeeds, false if the table is full.
+ */
+bool TWEFMT::register_packet_family(const PacketFamily& fam) {
+	return _the_classifier().add(fam);
+}
+
 /**
  * @fn	E_PKT TWEFMT::identify_packet_type(uint8_t* p, uint8_t u16len)
  *
@@ -19,60 +125,110 @@ using namespace TWEUTILS;
  * @returns	An packet id, E_PKT::PKT_ERROR in case of an error.
  */
 E_PKT TWEFMT::identify_packet_type(uint8_t* p, uint16_t u16len) {
+	const _PacketClassifier& cls = _the_classifier();
 	uint8_t* e = p + u16len;
-	E_PKT type = E_PKT::PKT_ERROR;
 
-	// TWELITE PAL
-	type = TwePacketPal::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
+	uint32_t m = cls.candidates(p, u16len);
+	for (int i = 0; m; i++, m >>= 1) {
+		if (!(m & 1)) continue;
 
-	// App Twelite 0x81 command
-	type = TwePacketTwelite::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
+		auto fam = cls.family(i, u16len);
+		if (fam == nullptr) continue;
 
-	// App IO 0x81
-	type = TwePacketAppIO::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
-	
-	// App UART
-	type = TwePacketAppUART::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
+		E_PKT type = fam->identify(p, e, u16len);
+		if (type != E_PKT::PKT_ERROR) return type;
+	}
 
-	// Act standard
-	type = TwePacketActStd::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
+	// UNKNOWN PKT
+	return E_PKT::PKT_ERROR;
+}
 
-	// Act TAG
-	type = TwePacketAppTAG::identify(p, e, u16len);
-	if (type != E_PKT::PKT_ERROR) return type;
+/**
+ * @fn	E_PKT TWEFMT::classify_packet(uint8_t* p, uint16_t u16len, bool (*try_decode)(const PacketFamily& fam, void* ctx), void* ctx)
+ *
+ * @brief	Tries the candidate families (the same as identify_packet_type()),
+ * 			the validation and decoding is done by try_decode() of the caller.
+ *
+ * @param [in]	p		  	payload.
+ * @param 	  	u16len	  	the length of 'p'.
+ * @param 	  	try_decode	returns true if the payload is decoded as the family.
+ * @param 	  	ctx		  	passed to try_decode().
+ *
+ * @returns	the id of the family, E_PKT::PKT_ERROR if none of them.
+ */
+E_PKT TWEFMT::classify_packet(uint8_t* p, uint16_t u16len, bool (*try_decode)(const PacketFamily& fam, void* ctx), void* ctx) {
+	const _PacketClassifier& cls = _the_classifier();
+
+	uint32_t m = cls.candidates(p, u16len);
+	for (int i = 0; m; i++, m >>= 1) {
+		if (!(m & 1)) continue;
+
+		auto fam = cls.family(i, u16len);
+		if (fam == nullptr) continue;
+
+		if (try_decode(*fam, ctx)) return fam->id;
+	}
 
-	// UNKNOWN PKT
 	return E_PKT::PKT_ERROR;
 }
 
-template <class T>
-inline spTwePacket _newTwePacket_parse(uint8_t* p, uint16_t u16len) {
-	auto sp = spTwePacket(new T());
-	sp->parse(p, u16len);
-	return sp;
+/**
+ * @fn	spTwePacket _newTwePacket_decode(uint8_t* p, uint16_t u16len, E_PKT_ERR& err)
+ *
+ * @brief	Identifies and decodes a packet at once (the candidates are the same as identify_packet_type()).
+ *
+ * @param [in,out]	p	 	payload.
+ * @param 		  	u16len	the length of 'p'.
+ * @param [out]	  	err   	the reason if failed.
+ *
+ * @returns	A spTwePacket, empty if failed.
+ */
+static spTwePacket _newTwePacket_decode(uint8_t* p, uint16_t u16len, E_PKT_ERR& err) {
+	const _PacketClassifier& cls = _the_classifier();
+	err = E_PKT_ERR::UNKNOWN;
+
+	uint32_t m = cls.candidates(p, u16len);
+	for (int i = 0; m; i++, m >>= 1) {
+		if (!(m & 1)) continue;
+
+		auto fam = cls.family(i, u16len);
+		if (fam == nullptr) continue;
+
+		E_PKT_ERR e = E_PKT_ERR::UNKNOWN;
+		auto sp = fam->decode(p, u16len, e);
+		if (sp) {
+			err = e;
+			return sp;
+		}
+		if (err == E_PKT_ERR::UNKNOWN) err = e; // keep the reason of the first family which matched the header.
+	}
+
+	// UNKNOWN PKT (or the reason of the failure)
+	return spTwePacket();
 }
 
 /**
- * @fn	spTwePacket TWEFMT::newTwePacket(uint8_t* p, uint16_t u16len, E_PKT eType = E_PKT::PKT_ERROR)
+ * @fn	spTwePacket TWEFMT::newTwePacket(uint8_t* p, uint16_t u16len, E_PKT eType = E_PKT::PKT_ERROR, E_PKT_ERR* perr = nullptr)
  *
  * @brief	Creates a new twe packet
  *
  * @param [in,out]	p	 	If non-null, an uint8_t to process.
  * @param 		  	u16len	The length.
- * @param 		  	eType	(Optional) The type.
+ * @param 		  	eType	(Optional) The type. if PKT_ERROR, identified while decoding.
+ * @param [out]	  	perr 	(Optional) If non-null, the reason of the error (E_PKT_ERR::NONE if decoded).
  *
  * @returns	A spTwePacket.
  */
-spTwePacket TWEFMT::newTwePacket(uint8_t* p, uint16_t u16len, E_PKT eType) {
+spTwePacket TWEFMT::newTwePacket(uint8_t* p, uint16_t u16len, E_PKT eType, E_PKT_ERR* perr) {
 	if (eType == E_PKT::PKT_ERROR) {
-		eType = identify_packet_type(p, u16len);
+		E_PKT_ERR err;
+		auto sp = _newTwePacket_decode(p, u16len, err);
+		if (perr) *perr = err;
+		return sp;
 	}
 
+	if (perr) *perr = E_PKT_ERR::NONE;
+
 	switch (eType) {
 	case E_PKT::PKT_PAL:
 		return _newTwePacket_parse<TwePacketPal>(p, u16len);
@@ -13,3 +13,7 @@
 #include "twe_fmt_appuart.hpp"
 #include "twe_fmt_actstd.hpp"
 #include "twe_fmt_apptag.hpp"
+
+#include "twe_fmt_record.hpp"
+#include "twe_fmt_batch.hpp"
+#include "twe_fmt_dedup.hpp"
@@ -56,7 +56,9 @@ E_PKT TwePacketAppTAG::parse(uint8_t* pb, uint16_t u16len) {
 
 	// rest of bytes
 	if (p < e) {
-		DataAppTAG::payload.reserve_and_set_empty(int(e - p));
+		// the buffer from the pool (no heap allocation in the steady state)
+		DataAppTAG::uptr_payload = new_snsbuf(size_t(e - p));
+		DataAppTAG::payload.attach(DataAppTAG::uptr_payload.get(), 0, uint16_t(e - p));
 		while (p != e) DataAppTAG::payload.push_back(*p++);
 	}
 
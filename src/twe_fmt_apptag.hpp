@@ -32,7 +32,8 @@ namespace TWEFMT {
 		uint8_t u8addr_src;
 
 		uint8_t u8sns;
-		TWEUTILS::SmplBuf_Byte payload;
+		TWEUTILS::SmplBuf_Byte payload; // attached to uptr_payload
+		uptr_snsbuf uptr_payload;       // see new_snsbuf()
 	};
 
 	class TwePacketAppTAG : public TwePacket, public DataAppTAG {
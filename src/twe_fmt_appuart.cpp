@@ -49,7 +49,12 @@ E_PKT TwePacketAppUART::parse(uint8_t* pyld, uint16_t u16len) {
 	if (pyld + DataAppUART::u16paylen != e) {
 		return E_PKT::PKT_ERROR;
 	}
-	while (pyld != e) DataAppUART::payload.push_back(*pyld++);
+	if (pyld != e) {
+		// the buffer from the pool (no heap allocation in the steady state)
+		DataAppUART::uptr_payload = new_snsbuf(size_t(e - pyld));
+		DataAppUART::payload.attach(DataAppUART::uptr_payload.get(), 0, uint16_t(e - pyld));
+		while (pyld != e) DataAppUART::payload.push_back(*pyld++);
+	}
 
 	TwePacket::common.clear();
 	TwePacket::common.tick = millis();
@@ -55,7 +55,8 @@ namespace TWEFMT {
 		/**
 		 * payload
 		 */
-		TWEUTILS::SmplBuf_Byte payload;
+		TWEUTILS::SmplBuf_Byte payload; // attached to uptr_payload
+		uptr_snsbuf uptr_payload;       // see new_snsbuf()
 	};
 
 	class TwePacketAppUART : public TwePacket, public DataAppUART {
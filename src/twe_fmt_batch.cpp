@@ -0,0 +1,327 @@
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include <string.h>
+#include "twe_fmt.hpp"
+#include "twe_fmt_batch.hpp"
+
+using namespace TWEFMT;
+using namespace TWEUTILS;
+
+// decoder objects, reused for every frame.
+struct PacketColumns::_decoders {
+	TwePacketPal pal;
+	TwePacketTwelite twelite;
+	TwePacketAppIO appio;
+	TwePacketAppUART appuart;
+	TwePacketAppTAG apptag;
+};
+
+static inline uint32_t _bit(E_REC_VAL kind) { return 1UL << uint8_t(kind); }
+
+/**
+ * @fn	PacketColumns::PacketColumns(uint16_t capacity, uint32_t smp_capacity)
+ *
+ * @brief	Constructor, all columns are allocated in one memory block.
+ *
+ * @param	capacity	max rows.
+ * @param	smp_capacity	max acceleration samples of all rows (0: capacity * ACCEL_SAMPLES_MAX).
+ */
+PacketColumns::PacketColumns(uint16_t capacity, uint32_t smp_capacity)
+	: _arena(), _dec(new _decoders()), _capacity(capacity), _size(0), _smp_capacity(smp_capacity), _smp_size(0)
+{
+	if (_smp_capacity == 0) _smp_capacity = uint32_t(capacity) * ACCEL_SAMPLES_MAX;
+	if (_smp_capacity < uint32_t(ACCEL_SAMPLES_MAX)) _smp_capacity = ACCEL_SAMPLES_MAX; // at least a packet
+
+	// layout (one for 8 bytes of the alignment margin of each column)
+	const size_t bytes_per_row = 1 + 1 + 4 + 1 + 1 + 2 + 4 + 1 + 2 + 4 // common
+		+ 2 + 2 + 4 + 2 + 2 + 2 + 2 + 1 + 1 + 2 + 2 + 2 + 2 + 2 + 1 + 4 // sensor values
+		+ 1 + 1 + 4; // event
+	const size_t bytes_per_smp = 2 + 2 + 2;
+	_arena.reset(new uint8_t[bytes_per_row * capacity + bytes_per_smp * _smp_capacity + 8 * 32]);
+
+	size_t off = 0;
+	type = _column<uint8_t>(off, capacity);
+	subtype = _column<uint8_t>(off, capacity);
+	sid = _column<uint32_t>(off, capacity);
+	lid = _column<uint8_t>(off, capacity);
+	lqi = _column<uint8_t>(off, capacity);
+	seq = _column<uint16_t>(off, capacity);
+	tick = _column<uint32_t>(off, capacity);
+	port = _column<uint8_t>(off, capacity);
+	vcc = _column<uint16_t>(off, capacity);
+	present = _column<uint32_t>(off, capacity);
+
+	temp = _column<int16_t>(off, capacity);
+	humid = _column<uint16_t>(off, capacity);
+	lumi = _column<uint32_t>(off, capacity);
+	adc1 = _column<uint16_t>(off, capacity);
+	adc2 = _column<uint16_t>(off, capacity);
+	adc3 = _column<uint16_t>(off, capacity);
+	adc4 = _column<uint16_t>(off, capacity);
+	adc_mask = _column<uint8_t>(off, capacity);
+	mag = _column<uint8_t>(off, capacity);
+	dio = _column<uint16_t>(off, capacity);
+	dio_active = _column<uint16_t>(off, capacity);
+	accel_x = _column<int16_t>(off, capacity);
+	accel_y = _column<int16_t>(off, capacity);
+	accel_z = _column<int16_t>(off, capacity);
+	accel_n = _column<uint8_t>(off, capacity);
+	smp_off = _column<uint32_t>(off, capacity);
+	smp_x = _column<int16_t>(off, _smp_capacity);
+	smp_y = _column<int16_t>(off, _smp_capacity);
+	smp_z = _column<int16_t>(off, _smp_capacity);
+
+	ev_src = _column<uint8_t>(off, capacity);
+	ev_id = _column<uint8_t>(off, capacity);
+	ev_param = _column<uint32_t>(off, capacity);
+}
+
+PacketColumns::~PacketColumns() {}
+
+/**
+ * @fn	int PacketColumns::_new_row()
+ *
+ * @brief	Clears the next row (not counted until decoded).
+ *
+ * @returns	the row index.
+ */
+int PacketColumns::_new_row() {
+	int i = _size;
+
+	type[i] = subtype[i] = lid[i] = lqi[i] = port[i] = 0;
+	sid[i] = tick[i] = present[i] = 0;
+	seq[i] = vcc[i] = 0;
+
+	temp[i] = 0; humid[i] = 0; lumi[i] = 0; mag[i] = 0;
+	adc1[i] = adc2[i] = adc3[i] = adc4[i] = 0; adc_mask[i] = 0;
+	dio[i] = 0; dio_active[i] = 0;
+	accel_x[i] = accel_y[i] = accel_z[i] = 0; accel_n[i] = 0; smp_off[i] = _smp_size;
+
+	ev_src[i] = ev_id[i] = 0; ev_param[i] = 0;
+
+	return i;
+}
+
+// acceleration samples (appended to smp_x/y/z) and the average
+template <class T>
+void PacketColumns::_accel(int i, T& d) {
+	if (d.u8samples == 0) return;
+
+	int n = d.u8samples < ACCEL_SAMPLES_MAX ? d.u8samples : ACCEL_SAMPLES_MAX; // full() keeps the room
+	uint32_t o = _smp_size;
+	int32_t x = 0, y = 0, z = 0;
+	for (int j = 0; j < n; j++) {
+		smp_x[o + j] = d.i16X[j]; x += d.i16X[j];
+		smp_y[o + j] = d.i16Y[j]; y += d.i16Y[j];
+		smp_z[o + j] = d.i16Z[j]; z += d.i16Z[j];
+	}
+	_smp_size += n;
+
+	accel_x[i] = int16_t(x / n);
+	accel_y[i] = int16_t(y / n);
+	accel_z[i] = int16_t(z / n);
+	accel_n[i] = uint8_t(n);
+	smp_off[i] = o;
+	present[i] |= _bit(E_REC_VAL::ACCEL);
+}
+
+// sensor values of PAL (by board type)
+void PacketColumns::_pal_row(int i, TwePacketPal& pal) {
+	subtype[i] = pal.u8board;
+	sid[i] = pal.u32addr_src;
+	lid[i] = pal.u8addr_src;
+	lqi[i] = pal.u8lqi;
+	seq[i] = pal.u16seq;
+	vcc[i] = pal.common.volt;
+	if (pal.common.volt) present[i] |= _bit(E_REC_VAL::VOLT);
+
+	switch (pal.e_board) {
+	case E_PAL_PCB::MAG: {
+		PalMag d = pal.get_PalMag();
+		if (d.u32StoredMask & 2) {
+			mag[i] = d.u8MagStat;
+			present[i] |= _bit(E_REC_VAL::MAG);
+		}
+	} break;
+
+	case E_PAL_PCB::AMB: {
+		PalAmb d = pal.get_PalAmb();
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_TEMP) { temp[i] = d.i16Temp; present[i] |= _bit(E_REC_VAL::TEMP); }
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_HUMID) { humid[i] = d.u16Humd; present[i] |= _bit(E_REC_VAL::HUMID); }
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_LUMI) { lumi[i] = d.u32Lumi; present[i] |= _bit(E_REC_VAL::LUMI); }
+	} break;
+
+	case E_PAL_PCB::MOT: {
+		PalMot d = pal.get_PalMot();
+		_accel(i, d);
+	} break;
+
+	case E_PAL_PCB::CUE: {
+		TweCUE d = pal.get_TweCUE();
+		if (d.u32StoredMask & TweCUE::STORE_ADC1_MASK) { adc1[i] = d.u16Adc1; adc_mask[i] |= 1; present[i] |= _bit(E_REC_VAL::ADC); }
+		if (d.u32StoredMask & TweCUE::STORE_MAG_MASK) { mag[i] = d.u8MagStat; present[i] |= _bit(E_REC_VAL::MAG); }
+		_accel(i, d);
+	} break;
+
+	case E_PAL_PCB::ARIA: {
+		TweARIA d = pal.get_TweARIA();
+		if (d.u32StoredMask & TweARIA::STORE_ADC1_MASK) { adc1[i] = d.u16Adc1; adc_mask[i] |= 1; present[i] |= _bit(E_REC_VAL::ADC); }
+		if (d.u32StoredMask & TweARIA::STORE_MAG_MASK) { mag[i] = d.u8MagStat; present[i] |= _bit(E_REC_VAL::MAG); }
+		if (d.u32StoredMask & TweARIA::STORE_VOLT_TEMP) { temp[i] = d.i16Temp; present[i] |= _bit(E_REC_VAL::TEMP); }
+		if (d.u32StoredMask & TweARIA::STORE_VOLT_HUMID) { humid[i] = d.u16Humd; present[i] |= _bit(E_REC_VAL::HUMID); }
+	} break;
+
+	default:
+		break;
+	}
+
+	if (pal.has_PalEvent()) {
+		PalEvent& ev = pal.get_PalEvent();
+		ev_src[i] = ev.u8event_source;
+		ev_id[i] = ev.u8event_id;
+		ev_param[i] = ev.u32event_param;
+		present[i] |= _bit(E_REC_VAL::EVENT);
+	}
+}
+
+// arguments of _try_decode()
+struct PacketColumns::_decode_ctx {
+	PacketColumns& c;
+	uint8_t* p;
+	uint16_t len;
+	int i;
+	TwePacket* pkt; // the decoder object (nullptr: not decoded)
+};
+
+/**
+ * @fn	bool PacketColumns::_try_decode(const PacketFamily& fam, void* ctx)
+ *
+ * @brief	Called from the classifier for each candidate family (see classify_packet()),
+ * 			validates and decodes the frame by the decoder object of the family, and fills the row.
+ *
+ * @returns	True if decoded.
+ */
+bool PacketColumns::_try_decode(const PacketFamily& fam, void* ctx) {
+	_decode_ctx& x = *static_cast<_decode_ctx*>(ctx);
+	PacketColumns& c = x.c;
+	_decoders& d = *c._dec;
+	uint8_t* p = x.p;
+	uint16_t len = x.len;
+	int i = x.i;
+
+	// PAL is validated and decoded at once (see _decode_pal()), the others are identified then parsed.
+	if (fam.id == E_PKT::PKT_PAL) {
+		if (!TwePacketPal::identify_header(p, len)) return false;
+
+		// clear the event and data info of the last packet (decode() may not update them).
+		static_cast<PalEvent&>(d.pal) = PalEvent();
+		static_cast<PalDataInfo&>(d.pal) = PalDataInfo();
+
+		E_PKT_ERR err = d.pal.decode(p, len);
+		if (err != E_PKT_ERR::NONE && err != E_PKT_ERR::PAL_DATA) return false;
+
+		x.pkt = &d.pal;
+		c._pal_row(i, d.pal);
+		return true;
+	}
+
+	if (fam.identify(p, p + len, len) == E_PKT::PKT_ERROR) return false;
+
+	switch (fam.id) {
+	case E_PKT::PKT_TWELITE: {
+		auto& y = d.twelite;
+		if (y.parse(p, len) == E_PKT::PKT_ERROR) return false;
+		x.pkt = &y;
+		c.sid[i] = y.u32addr_src;
+		c.lid[i] = y.u8addr_src;
+		c.lqi[i] = y.u8lqi;
+		c.seq[i] = y.u16timestamp;
+		c.vcc[i] = y.u16Volt;
+		c.dio[i] = y.DI_mask;
+		c.dio_active[i] = y.DI_active_mask;
+		c.present[i] |= _bit(E_REC_VAL::VOLT) | _bit(E_REC_VAL::DI);
+		if (y.Adc_active_mask & 1) c.adc1[i] = y.u16Adc1;
+		if (y.Adc_active_mask & 2) c.adc2[i] = y.u16Adc2;
+		if (y.Adc_active_mask & 4) c.adc3[i] = y.u16Adc3;
+		if (y.Adc_active_mask & 8) c.adc4[i] = y.u16Adc4;
+		c.adc_mask[i] = uint8_t(y.Adc_active_mask & 0x0F);
+		if (c.adc_mask[i]) c.present[i] |= _bit(E_REC_VAL::ADC);
+	} break;
+
+	case E_PKT::PKT_APPIO: {
+		auto& y = d.appio;
+		if (y.parse(p, len) == E_PKT::PKT_ERROR) return false;
+		x.pkt = &y;
+		c.sid[i] = y.u32addr_src;
+		c.lid[i] = y.u8addr_src;
+		c.lqi[i] = y.u8lqi;
+		c.seq[i] = y.u16timestamp;
+		c.dio[i] = y.DI_mask;
+		c.dio_active[i] = y.DI_active_mask;
+		c.present[i] |= _bit(E_REC_VAL::DI);
+	} break;
+
+	case E_PKT::PKT_APPUART:
+	case E_PKT::PKT_ACT_STD: {
+		auto& y = d.appuart;
+		if (y.parse(p, len) == E_PKT::PKT_ERROR) return false;
+		x.pkt = &y;
+		c.subtype[i] = y.u8response_id;
+		c.sid[i] = y.u32addr_src;
+		c.lid[i] = y.u8addr_src;
+		c.lqi[i] = y.u8lqi;
+	} break;
+
+	case E_PKT::PKT_APPTAG: {
+		auto& y = d.apptag;
+		if (y.parse(p, len) == E_PKT::PKT_ERROR) return false;
+		x.pkt = &y;
+		c.subtype[i] = y.u8sns;
+		c.sid[i] = y.u32addr_src;
+		c.lid[i] = y.u8addr_src;
+		c.lqi[i] = y.u8lqi;
+		c.seq[i] = y.u16seq;
+		c.vcc[i] = y.u16Volt;
+		c.present[i] |= _bit(E_REC_VAL::VOLT);
+	} break;
+
+	default:
+		return false; // the families registered by the application have no columns.
+	}
+
+	return true;
+}
+
+/**
+ * @fn	bool PacketColumns::decode(uint8_t* p, uint16_t len, uint32_t t, uint8_t prt)
+ *
+ * @brief	Decodes a frame and appends a row.
+ * 			The candidate families are given by the classifier (classify_packet(), the same
+ * 			order as newTwePacket()), then the decoder object of the family is reused.
+ *
+ * @param [in]	p  	payload.
+ * @param 	  	len	the length.
+ * @param 	  	t  	arrival tick (0: the time of decoding)
+ * @param 	  	prt	source port index.
+ *
+ * @returns	True if a row is appended, false if full or not decoded.
+ */
+bool PacketColumns::decode(uint8_t* p, uint16_t len, uint32_t t, uint8_t prt) {
+	if (full()) return false;
+
+	_decode_ctx ctx = { *this, p, len, _new_row(), nullptr };
+	E_PKT typ = classify_packet(p, len, _try_decode, &ctx);
+
+	if (ctx.pkt == nullptr) {
+		_smp_size = smp_off[ctx.i]; // discard the samples of the failed row
+		return false;
+	}
+
+	int i = ctx.i;
+	type[i] = uint8_t(typ);
+	tick[i] = t ? t : ctx.pkt->common.tick;
+	port[i] = prt;
+	_size++;
+	return true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+/*****************************************************
+ * BATCH DECODE
+ *   decodes completed frames into column arrays
+ *   (struct of arrays), for bulk DB inserts, graph
+ *   buffers or CSV writers.
+ *****************************************************/
+
+#include "twe_fmt_common.hpp"
+#include "twe_fmt_twelite.hpp"
+#include "twe_fmt_pal.hpp"
+#include "twe_fmt_appio.hpp"
+#include "twe_fmt_appuart.hpp"
+#include "twe_fmt_apptag.hpp"
+#include "twe_fmt_record.hpp"
+
+namespace TWEFMT {
+	/**
+	 * @class	PacketColumns
+	 *
+	 * @brief	Decoded packets in column arrays. Row i of each column is the i-th decoded frame.
+	 * 			The columns are allocated once at construction, and decode() reuses a decoder
+	 * 			object per packet family (no packet object is created per frame).
+	 *
+	 * 			The sensor value columns are valid if the bit (1 << E_REC_VAL) of present[i] is set.
+	 * 			  - TEMP: temp, HUMID: humid, LUMI: lumi, MAG: mag
+	 * 			  - ADC: adc1..adc4, each is valid if the bit (1 << (n - 1)) of adc_mask[i] is set
+	 * 			  - DI: dio, dio_active
+	 * 			  - ACCEL: accel_x/y/z (average of the samples), accel_n (count of the samples),
+	 * 			           smp_x/y/z[smp_off[i] .. smp_off[i] + accel_n[i] - 1] (the samples)
+	 * 			  - EVENT: ev_src, ev_id, ev_param
+	 */
+	class PacketColumns {
+		struct _decoders;
+
+		std::unique_ptr<uint8_t[]> _arena;
+		std::unique_ptr<_decoders> _dec;
+		uint16_t _capacity;
+		uint16_t _size;
+		uint32_t _smp_capacity;
+		uint32_t _smp_size;
+
+		template <typename T>
+		T* _column(size_t& off, size_t n) {
+			off = (off + alignof(T) - 1) & ~(alignof(T) - 1);
+			T* p = reinterpret_cast<T*>(_arena.get() + off);
+			off += sizeof(T) * n;
+			return p;
+		}
+
+		// allocate a row (not filled)
+		int _new_row();
+
+		// decode the frame into row i by the family (called from the classifier)
+		struct _decode_ctx;
+		static bool _try_decode(const PacketFamily& fam, void* ctx);
+		template <class T> void _accel(int i, T& d);
+		void _pal_row(int i, TwePacketPal& pal);
+
+	public:
+		// common
+		uint8_t* type;        // E_PKT
+		uint8_t* subtype;     // PAL: E_PAL_PCB, App UART/Act: response id, App TAG: sensor type
+		uint32_t* sid;        // source address (Serial ID)
+		uint8_t* lid;         // source address (logical ID)
+		uint8_t* lqi;         // LQI
+		uint16_t* seq;        // sequence number or time stamp
+		uint32_t* tick;       // arrival tick of the frame
+		uint8_t* port;        // source port index
+		uint16_t* vcc;        // module voltage [mV] (0: unknown)
+		uint32_t* present;    // bit mask of E_REC_VAL (1 << kind)
+
+		// sensor values
+		int16_t* temp;        // [100x degC]
+		uint16_t* humid;      // [100x %]
+		uint32_t* lumi;       // [lux]
+		uint16_t* adc1;       // [mV]
+		uint16_t* adc2;       // [mV]
+		uint16_t* adc3;       // [mV]
+		uint16_t* adc4;       // [mV]
+		uint8_t* adc_mask;    // valid ADC channels (bit0: adc1 .. bit3: adc4)
+		uint8_t* mag;         // magnet sensor state
+		uint16_t* dio;        // DI state mask
+		uint16_t* dio_active; // DI active mask
+		int16_t* accel_x;     // [mG]
+		int16_t* accel_y;
+		int16_t* accel_z;
+		uint8_t* accel_n;
+		uint32_t* smp_off;    // the first sample of the row in smp_x/y/z
+		int16_t* smp_x;       // acceleration samples of all rows [mG] (accel_n[i] samples from smp_off[i])
+		int16_t* smp_y;
+		int16_t* smp_z;
+
+		// event
+		uint8_t* ev_src;
+		uint8_t* ev_id;
+		uint32_t* ev_param;
+
+		static const int ACCEL_SAMPLES_MAX = 16; // the most samples of a packet (MOT PAL)
+
+		// capacity: max rows, smp_capacity: max acceleration samples of all rows (0: capacity * ACCEL_SAMPLES_MAX)
+		PacketColumns(uint16_t capacity, uint32_t smp_capacity = 0);
+		~PacketColumns();
+		PacketColumns(const PacketColumns&) = delete;
+		PacketColumns& operator = (const PacketColumns&) = delete;
+
+		inline uint16_t capacity() const { return _capacity; }
+		inline uint16_t size() const { return _size; }
+		inline uint32_t smp_capacity() const { return _smp_capacity; }
+		inline uint32_t smp_size() const { return _smp_size; }
+		inline bool full() const { return _size >= _capacity || _smp_size + ACCEL_SAMPLES_MAX > _smp_capacity; }
+		inline void clear() { _size = 0; _smp_size = 0; }
+
+		inline bool has(int i, E_REC_VAL kind) const { return (present[i] & (1UL << uint8_t(kind))) != 0; }
+
+		// decode a frame and append a row, returns false if full or not decoded.
+		// tick is the arrival tick of the frame (0: the time of decoding).
+		bool decode(uint8_t* p, uint16_t len, uint32_t tick = 0, uint8_t port = 0);
+
+		// decode the frames (e.g. popped from FramePool) until full, returns the count of the frames consumed.
+		// the frames which are not decoded are consumed without a row.
+		size_t decode(TWESERCMD::FrameRef* frames, size_t n, uint8_t port = 0) {
+			size_t i = 0;
+			for (; i < n && !full(); i++) {
+				decode(frames[i].data(), frames[i].length(), frames[i].tick(), port);
+			}
+			return i;
+		}
+	};
+}
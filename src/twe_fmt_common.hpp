@@ -8,6 +8,7 @@
 #include "twe_utils.hpp"
 #include "twe_sercmd.hpp"
 #include "twe_utils_simplebuffer.hpp"
+#include "twe_fmt_pool.hpp"
 
 #include <memory>
 
@@ -25,6 +26,15 @@ namespace TWEFMT {
 		PKT_ACT_STD  // for Act Standard packet structure
 	};
 
+	// reason of the decode error (see newTwePacket(p, len, eType, perr)).
+	enum class E_PKT_ERR : uint8_t {
+		NONE = 0,    // decoded
+		UNKNOWN,     // no packet type matches
+		PAL_LENGTH,  // PAL: the sensor data exceeds the frame
+		PAL_CRC,     // PAL: CRC8 mismatch
+		PAL_DATA     // PAL: data info or event is broken (the packet object is returned)
+	};
+
 	class TwePacket {
 	protected:
 		const E_PKT _type;
@@ -42,12 +52,14 @@ namespace TWEFMT {
 			uint8_t src_lid;
 			uint8_t lqi;
 			uint16_t volt;
+			uint8_t port; // source port index (0: primary, see SerialMulti)
 			void clear() {
 				tick = 0;
 				src_addr = 0;
 				src_lid = 0;
 				lqi = 0;
 				volt = 0;
+				port = 0;
 			}
 		} common;
 	};
@@ -58,6 +70,30 @@ namespace TWEFMT {
 	// type definition (shared_ptr)
 	typedef std::shared_ptr<TwePacket> spTwePacket;
 
+	/**
+	 * @struct	PacketFamily
+	 *
+	 * @brief	An entry of the packet classifier (see register_packet_family()).
+	 * 			The classifier looks up the candidates by p[1] of the payload,
+	 * 			then tries them in the order of registration.
+	 */
+	struct PacketFamily {
+		E_PKT id;       // packet type
+		int16_t key;    // value of p[1] (e.g. 0x81 command), -1: any value
+		uint16_t len;   // fixed length of the payload, 0: variable
+		E_PKT (*identify)(uint8_t* p, uint8_t* e, uint16_t len);          // validates the payload
+		spTwePacket (*decode)(uint8_t* p, uint16_t len, E_PKT_ERR& err);  // validates and decodes (empty if not matched)
+	};
+
+	// add a packet family to the classifier with the lowest priority (call before receiving packets).
+	// returns false if the table is full.
+	bool register_packet_family(const PacketFamily& fam);
+
+	// tries the candidate families of the payload in the order of the classifier,
+	// try_decode() validates and decodes it by the caller (e.g. into a reused object), returns true if matched.
+	// returns the id of the matched family, E_PKT::PKT_ERROR if none of them.
+	E_PKT classify_packet(uint8_t* p, uint16_t len, bool (*try_decode)(const PacketFamily& fam, void* ctx), void* ctx);
+
 	// check byte sequence and tell packet type.
 	E_PKT identify_packet_type(uint8_t* p, uint16_t len);
 	static inline E_PKT identify_packet_type(TWEUTILS::SmplBuf_Byte& sbuff) {
@@ -76,9 +112,23 @@ namespace TWEFMT {
 	}
 
 	// Generic TWE Packet object generation
-	spTwePacket newTwePacket(uint8_t* p, uint16_t len, E_PKT eType = E_PKT::PKT_ERROR);
+	//   if eType is PKT_ERROR, the type is identified while decoding (each frame is traversed once),
+	//   and the reason is stored into *perr on failure.
+	spTwePacket newTwePacket(uint8_t* p, uint16_t len, E_PKT eType = E_PKT::PKT_ERROR, E_PKT_ERR* perr = nullptr);
 	static inline spTwePacket newTwePacket(TWEUTILS::SmplBuf_Byte& sbuff, E_PKT eType = E_PKT::PKT_ERROR) {
-		return newTwePacket(sbuff.data(), (uint8_t)sbuff.length(), eType);
+		return newTwePacket(sbuff.data(), uint16_t(sbuff.length()), eType);
+	}
+	// from the completed parser, common.tick is the arrival tick of the frame (if available).
+	static inline spTwePacket newTwePacket(TWESERCMD::IParser& parser, E_PKT eType = E_PKT::PKT_ERROR) {
+		spTwePacket pkt = newTwePacket(parser.get_payload(), eType);
+		if (pkt && parser.get_tick() != 0) pkt->common.tick = parser.get_tick();
+		return pkt;
+	}
+	// from the frame popped from FramePool.
+	static inline spTwePacket newTwePacket(TWESERCMD::FrameRef& frame, E_PKT eType = E_PKT::PKT_ERROR) {
+		spTwePacket pkt = newTwePacket(frame.data(), uint16_t(frame.length()), eType);
+		if (pkt && frame.tick() != 0) pkt->common.tick = frame.tick();
+		return pkt;
 	}
 
 	// reference to TwePacket for spTwePacket
@@ -0,0 +1,172 @@
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include "twe_fmt_dedup.hpp"
+#include "twe_fmt_stdin.h"
+
+using namespace TWEFMT;
+
+// FNV-1a hash
+static inline uint32_t _fnv1a(uint32_t h, const uint8_t* p, const uint8_t* e) {
+	for (; p < e; p++) {
+		h ^= *p;
+		h *= 16777619UL;
+	}
+	return h;
+}
+static const uint32_t FNV_BASIS = 2166136261UL;
+
+// the key of the raw frame
+struct _dedup_key {
+	uint32_t u32addr_src;
+	uint32_t u32hash;
+	uint16_t u16seq;
+	uint8_t u8fam;
+	uint8_t u8lqi;
+};
+
+/**
+ * @fn	static bool _dedup_key_of(const uint8_t* p, uint16_t len, _dedup_key& k)
+ *
+ * @brief	Reads the key from the raw frame (see parse()/decode() of each family).
+ * 			The family is told by the classifier, in the same order as identify_packet_type()
+ * 			(e.g. App UART/Act frames may also have the MSB of p[0] and p[7]).
+ * 			The repeaters change the repeater address and LQI (PAL, App TAG) or
+ * 			LQI and repeat count (App Twelite, App IO), they are excluded from the hash.
+ * 			The CRC8 at the end of PAL covers them, it is also excluded.
+ *
+ * @returns	false if the frame has no key.
+ */
+static bool _dedup_key_of(const uint8_t* p, uint16_t len, _dedup_key& k) {
+	const uint8_t* e = p + len;
+
+	E_PKT fam = identify_packet_type(const_cast<uint8_t*>(p), len);
+
+	if (fam == E_PKT::PKT_PAL || fam == E_PKT::PKT_APPTAG) {
+		// PAL, App TAG: rpt addr(4) lqi(1) seq(2) src(4) lid(1) 0x80 or sensor type(1) ...
+		k.u8fam = uint8_t(fam);
+		k.u8lqi = p[4];
+		k.u16seq = uint16_t(p[5] << 8 | p[6]);
+		k.u32addr_src = uint32_t(p[7]) << 24 | uint32_t(p[8]) << 16 | uint32_t(p[9]) << 8 | p[10];
+		k.u32hash = _fnv1a(FNV_BASIS, p + 5, k.u8fam == uint8_t(E_PKT::PKT_PAL) ? e - 1 : e);
+	}
+	else if (fam == E_PKT::PKT_TWELITE || fam == E_PKT::PKT_APPIO) {
+		// App Twelite, App IO: lid(1) 0x81 id(1) ver(1) lqi(1) src(4) dst(1) timestamp(2) rpt cnt(1) ...
+		k.u8fam = uint8_t(fam);
+		k.u8lqi = p[4];
+		k.u16seq = uint16_t((p[10] << 8 | p[11]) & 0x7FFF);
+		k.u32addr_src = uint32_t(p[5]) << 24 | uint32_t(p[6]) << 16 | uint32_t(p[7]) << 8 | p[8];
+		uint32_t h = _fnv1a(FNV_BASIS, p, p + 4);
+		h = _fnv1a(h, p + 5, p + 12);
+		k.u32hash = _fnv1a(h, p + 13, e);
+	}
+	else {
+		return false;
+	}
+
+	if (k.u32hash == 0) k.u32hash = 1; // 0 is for the empty slot
+	return true;
+}
+
+/**
+ * @fn	PacketDedup::PacketDedup(uint16_t slots, uint32_t window_ms, bool pass_better)
+ *
+ * @brief	Constructor, the table is allocated here.
+ *
+ * @param	slots	   	table size (rounded up to the power of 2).
+ * @param	window_ms  	time window of duplicates [ms].
+ * @param	pass_better	accept() passes the copy of better LQI.
+ * @param	enabled	   	false: accept() passes all frames (see set_enabled()).
+ */
+PacketDedup::PacketDedup(uint16_t slots, uint32_t window_ms, bool pass_better, bool enabled)
+	: _tbl(), _mask(0), _window_ms(window_ms), _b_pass_better(pass_better), _b_enabled(enabled)
+	, _u32passed(0), _u32suppressed(0), _u32better(0), _u32evicted(0)
+{
+	uint32_t n = PROBE;
+	while (n < slots) n <<= 1;
+
+	_tbl.reset(new _entry[n]);
+	_mask = n - 1;
+	clear();
+}
+
+/**
+ * @fn	void PacketDedup::clear()
+ *
+ * @brief	Clears the entries.
+ */
+void PacketDedup::clear() {
+	for (uint32_t i = 0; i <= _mask; i++) {
+		_tbl[i] = _entry();
+	}
+}
+
+/**
+ * @fn	E_DEDUP PacketDedup::check(const uint8_t* p, uint16_t len, uint32_t tick)
+ *
+ * @brief	Checks if the frame is a copy of the recent one, and records it.
+ *
+ * @param [in]	p   	payload.
+ * @param 	  	len 	the length.
+ * @param 	  	tick	arrival tick (0: the time of checking).
+ *
+ * @returns	E_DEDUP (UNKNOWN if disabled).
+ */
+E_DEDUP PacketDedup::check(const uint8_t* p, uint16_t len, uint32_t tick) {
+	_dedup_key k;
+	if (!_b_enabled || p == nullptr || !_dedup_key_of(p, len, k)) return E_DEDUP::UNKNOWN;
+	if (tick == 0) tick = millis();
+
+	// slot index
+	uint32_t h = k.u32addr_src ^ (uint32_t(k.u16seq) << 16 | k.u8fam);
+	h *= 0x9E3779B1UL;
+	h ^= h >> 16;
+
+	_entry* slot = nullptr; // to store the new entry
+	uint32_t age_max = 0;
+
+	for (int i = 0; i < PROBE; i++) {
+		_entry& x = _tbl[(h + i) & _mask];
+		uint32_t age = tick - x.u32tick;
+		bool live = x.u32hash != 0 && age < _window_ms;
+
+		if (live
+			&& x.u32addr_src == k.u32addr_src && x.u16seq == k.u16seq
+			&& x.u8fam == k.u8fam && x.u32hash == k.u32hash
+		) {
+			// a copy
+			if (k.u8lqi > x.u8lqi) {
+				x.u8lqi = k.u8lqi;
+				_u32better++;
+				if (_b_pass_better) _u32passed++; else _u32suppressed++;
+				return E_DEDUP::BETTER_LQI;
+			}
+			_u32suppressed++;
+			return E_DEDUP::DUPLICATE;
+		}
+
+		// the empty (expired) slot, or the oldest one.
+		if (!live) {
+			if (slot == nullptr || age_max != 0xFFFFFFFF) {
+				slot = &x;
+				age_max = 0xFFFFFFFF;
+			}
+		}
+		else if (slot == nullptr || age > age_max) {
+			slot = &x;
+			age_max = age;
+		}
+	}
+
+	if (age_max != 0xFFFFFFFF) _u32evicted++;
+
+	slot->u32addr_src = k.u32addr_src;
+	slot->u32hash = k.u32hash;
+	slot->u32tick = tick;
+	slot->u16seq = k.u16seq;
+	slot->u8fam = k.u8fam;
+	slot->u8lqi = k.u8lqi;
+
+	_u32passed++;
+	return E_DEDUP::NEW;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+/*****************************************************
+ * DUPLICATE SUPPRESSION
+ *   the same packet arrives several times via repeaters
+ *   (or several parent devices), the copies are found
+ *   from the raw frame before decoding.
+ *****************************************************/
+
+#include "twe_fmt_common.hpp"
+
+namespace TWEFMT {
+	// result of PacketDedup::check()
+	enum class E_DEDUP : uint8_t {
+		NEW = 0,     // first copy in the window
+		DUPLICATE,   // already seen
+		BETTER_LQI,  // already seen, but LQI is better than the copies before
+		UNKNOWN      // the key is not available (App UART, Act, broken frames), not checked
+	};
+
+	/**
+	 * @class	PacketDedup
+	 *
+	 * @brief	Cache of the recent packets keyed on family + source address + sequence number,
+	 * 			to suppress the copies relayed by repeaters (App Twelite, App IO, PAL and App TAG).
+	 * 			The key and a hash of the payload (except repeater address, LQI and repeat count)
+	 * 			are read from the raw frame, so the copies are not decoded.
+	 *
+	 * 			The table has a fixed number of slots (bounded memory) and an entry expires
+	 * 			after the time window. check() probes a few slots (O(1)), the oldest one
+	 * 			is evicted when all of them are in use.
+	 *
+	 * 			The stage is optional, if disabled (set_enabled(false)), all frames are passed
+	 * 			without checking.
+	 */
+	class PacketDedup {
+		static const int PROBE = 4; // slots checked for a key
+
+		struct _entry {
+			uint32_t u32addr_src;
+			uint32_t u32hash;  // payload hash (0: empty slot)
+			uint32_t u32tick;  // arrival tick of the first copy
+			uint16_t u16seq;
+			uint8_t u8fam;     // E_PKT
+			uint8_t u8lqi;     // the best LQI of the copies
+		};
+
+		std::unique_ptr<_entry[]> _tbl;
+		uint32_t _mask;
+		uint32_t _window_ms;
+		bool _b_pass_better;
+		bool _b_enabled;
+
+		uint32_t _u32passed;
+		uint32_t _u32suppressed;
+		uint32_t _u32better;
+		uint32_t _u32evicted;
+
+	public:
+		static const uint32_t DEFAULT_WINDOW_MS = 3000;
+
+		// slots: table size (rounded up to the power of 2),
+		// window_ms: time window of duplicates,
+		// pass_better: accept() passes the copy of better LQI (to replace the stored value),
+		// enabled: false to pass all frames (e.g. by the settings).
+		PacketDedup(uint16_t slots = 256, uint32_t window_ms = DEFAULT_WINDOW_MS, bool pass_better = true, bool enabled = true);
+		PacketDedup(const PacketDedup&) = delete;
+		PacketDedup& operator = (const PacketDedup&) = delete;
+
+		// enable/disable the stage (the entries are cleared when disabled)
+		inline void set_enabled(bool b) { _b_enabled = b; if (!b) clear(); }
+		inline bool is_enabled() const { return _b_enabled; }
+
+		// check a frame and record it, tick is the arrival tick (0: the time of checking).
+		E_DEDUP check(const uint8_t* p, uint16_t len, uint32_t tick = 0);
+		inline E_DEDUP check(TWESERCMD::IParser& parser) {
+			auto& payl = parser.get_payload();
+			return check(payl.data(), uint16_t(payl.length()), parser.get_tick());
+		}
+		inline E_DEDUP check(TWESERCMD::FrameRef& frame) {
+			return check(frame.data(), frame.length(), frame.tick());
+		}
+
+		// true if the frame should be decoded.
+		inline bool accept(E_DEDUP r) const {
+			return r != E_DEDUP::DUPLICATE && (r != E_DEDUP::BETTER_LQI || _b_pass_better);
+		}
+		inline bool accept(TWESERCMD::IParser& parser) { return accept(check(parser)); }
+		inline bool accept(TWESERCMD::FrameRef& frame) { return accept(check(frame)); }
+
+		// clear the entries (the counters are kept)
+		void clear();
+
+		// counters
+		inline uint32_t passed() const { return _u32passed; }         // NEW (and BETTER_LQI if passed)
+		inline uint32_t suppressed() const { return _u32suppressed; } // copies not passed
+		inline uint32_t better() const { return _u32better; }         // copies of better LQI
+		inline uint32_t evicted() const { return _u32evicted; }       // live entries overwritten (table is too small)
+		inline void clear_counters() { _u32passed = _u32suppressed = _u32better = _u32evicted = 0; }
+	};
+}
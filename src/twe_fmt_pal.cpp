@@ -7,17 +7,29 @@
 using namespace TWEFMT;
 using namespace TWEUTILS;
 
-E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
+/**
+ * @fn	E_PKT_ERR TwePacketPal::decode(uint8_t* pb, uint16_t u16len)
+ *
+ * @brief	Validates and decodes the packet in a single pass.
+ * 			The sensor headers are walked and CRC8 is calculated once (identify() is not necessary).
+ *
+ * @param [in,out]	pb	  	payload.
+ * @param 		  	u16len	the length.
+ *
+ * @returns	E_PKT_ERR::NONE if decoded, PAL_LENGTH or PAL_CRC if not a valid PAL packet,
+ * 			PAL_DATA if data info or event is broken.
+ */
+E_PKT_ERR TwePacketPal::decode(uint8_t* pb, uint16_t u16len) {
 	uint8_t* p = pb;
 	uint8_t* e = pb + u16len;
 	uint8_t c = 0;
-	bool bErr = false;
+	E_PKT_ERR err = E_PKT_ERR::NONE;
 
 	TwePacket::common.clear();
 
 	// at least 11 bytes are necessary
 	if (u16len < 11) {
-		return E_PKT::PKT_ERROR;
+		return E_PKT_ERR::PAL_LENGTH;
 	}
 
 	// the first 4 bytes: ser# of router or 0x80000000(direct)
@@ -38,7 +50,7 @@ E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
 	// 0x80 fixed
 	c = G_OCTET(p);
 	if (c != 0x80) {
-		return E_PKT::PKT_ERROR;
+		return E_PKT_ERR::UNKNOWN;
 	}
 
 	// PAL pcb & data format
@@ -56,6 +68,7 @@ E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
 
 	// check data
 	int iStored = 0;
+	_u8sns_kind_ct = 0;
 	// Sensors.clear(); // clear map structure
 	for (int i = 0; i < u8sensors; i++) {
 		// check header len
@@ -68,37 +81,58 @@ E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
 		uint8_t u8ln = G_OCTET(p);
 
 		// check payload len
-		if (e < p + u8ln) { break; }
+		if (e < p + u8ln) { p -= 4; break; }
+
+		// add to the index (the first offset and the count by data source)
+		if (_u8sns_kind_ct <= SNS_KIND_MAX) {
+			int k = 0;
+			while (k < _u8sns_kind_ct && _sns_kind[k].u8ds != u8ds) k++;
+
+			if (k < _u8sns_kind_ct) {
+				_sns_kind[k].u8ct++;
+			}
+			else if (k < SNS_KIND_MAX) {
+				_sns_kind[k] = { uint16_t(p - 4 - psensor), u8ds, 1 };
+				_u8sns_kind_ct++;
+			}
+			else {
+				_u8sns_kind_ct = 0xFF; // too many kinds
+			}
+		}
 
 		// update counters, pointers
 		iStored++;
 		p += u8ln;
 	}
 
-	if (iStored != u8sensors) {
+	// the end of sensor data (CRC8 follows)
+	uint8_t* psensor_end = p;
+
+	if (iStored != u8sensors || p >= e) {
 		// some error but accept parse sensor data.
 		u8sensors = iStored;
-		bErr = true;
+		err = E_PKT_ERR::PAL_LENGTH;
 	}
 	else {
 		// perform checksum check
-		uint8_t u8crc = TWEUTILS::CRC8_u8Calc(pb, (uint8_t)(p - pb));
+		uint8_t u8crc = TWEUTILS::CRC8_u8Calc(pb, size_t(p - pb));
 		uint8_t c = G_OCTET(p);
-		if (c != u8crc) bErr = true;
+		if (c != u8crc) err = E_PKT_ERR::PAL_CRC;
 	}
 
 	// copy data (copy serial format as is)
-	int len = int((p - 1) - psensor);
-	if (len <= sizeof(au8snsdata)) { // TODO
+	int len = int(psensor_end - psensor);
+	if (len <= int(sizeof(au8snsdata))) {
 		// copy data into pre-allocated area
 		memcpy(au8snsdata, psensor, len);
-		u8snsdatalen = len;
+		u16snsdatalen = uint16_t(len);
+		uptr_snsdata.reset();
 	}
 	else {
-		// allocate with unique pointer. (note: dynamic allocation with new operator)
-		uptr_snsdata.reset(new uint8_t[len]);
+		// allocate from the pool of sensor data buffers.
+		uptr_snsdata = new_snsbuf(len);
 		memcpy(uptr_snsdata.get(), psensor, len);
-		u8snsdatalen = len | 0x8000;
+		u16snsdatalen = uint16_t(len | 0x8000);
 	}
 
 	// store common data
@@ -107,53 +141,59 @@ E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
 	TwePacket::common.src_lid = DataPal::u8addr_src;
 	TwePacket::common.lqi = DataPal::u8lqi;
 
+	if (err != E_PKT_ERR::NONE) {
+		return err;
+	}
+
 	// store volt data
-	if (!bErr) {
-		auto res_volt = query_volt();
-		if (res_volt.first) {
-			TwePacket::common.volt = res_volt.second;
-		}
+	auto res_volt = query_volt();
+	if (res_volt.first) {
+		TwePacket::common.volt = res_volt.second;
 	}
 
 	// query data info
-	if (!bErr) {
-		if (DataPal::has_data_info()) {
-			auto res_data_info = query_data_info();
+	if (DataPal::has_data_info()) {
+		auto res_data_info = query_data_info();
 
-			if (res_data_info.first) {
-				static_cast<PalDataInfo&>(*this) = res_data_info.second;
-			}
-			else {
-				bErr = true;
-			}
+		if (res_data_info.first) {
+			static_cast<PalDataInfo&>(*this) = res_data_info.second;
+		}
+		else {
+			return E_PKT_ERR::PAL_DATA;
 		}
 	}
 
 	// query event data
-	if (!bErr) {
-		if (!DataPal::has_data_info() || (DataPal::has_data_info() && PalDataInfo::_b_stored_pal_event)) {
-			auto res_ev = query_event();
+	if (!DataPal::has_data_info() || (DataPal::has_data_info() && PalDataInfo::_b_stored_pal_event)) {
+		auto res_ev = query_event();
 
-			// flag is set, but no data (should be an error)
-			if (DataPal::has_data_info() && PalDataInfo::_b_stored_pal_event && !res_ev.first) {
-				bErr = true;
-			}
+		// flag is set, but no data (should be an error)
+		if (DataPal::has_data_info() && PalDataInfo::_b_stored_pal_event && !res_ev.first) {
+			return E_PKT_ERR::PAL_DATA;
+		}
 
-			// copy data if present
-			if (!bErr) {
-				if (res_ev.first) {
-					PalDataInfo::_b_stored_pal_event = true;
-					static_cast<PalEvent&>(*this) = res_ev.second;
-				}
-				else {
-					PalDataInfo::_b_stored_pal_event = false;
-				}
-			}
+		// copy data if present
+		if (res_ev.first) {
+			PalDataInfo::_b_stored_pal_event = true;
+			static_cast<PalEvent&>(*this) = res_ev.second;
+		}
+		else {
+			PalDataInfo::_b_stored_pal_event = false;
 		}
 	}
 
-	// return packet ID
-	return bErr ? E_PKT::PKT_ERROR : E_PKT::PKT_PAL;
+	return E_PKT_ERR::NONE;
+}
+
+/**
+ * @fn	E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len)
+ *
+ * @brief	Parses the packet (see decode()).
+ *
+ * @returns	E_PKT::PKT_PAL if decoded, otherwise E_PKT::PKT_ERROR.
+ */
+E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
+	return decode(pb, u16len) == E_PKT_ERR::NONE ? E_PKT::PKT_PAL : E_PKT::PKT_ERROR;
 }
 
 /**
@@ -167,15 +207,72 @@ E_PKT TwePacketPal::parse(uint8_t* pb, uint16_t u16len) {
  * @returns	A spTwePacketPal.
  */
 spTwePacketPal TWEFMT::newTwePacketPal(uint8_t* p, uint16_t u16len) {
-	auto pobj = std::make_shared<TwePacketPal>();
+	auto pobj = make_pooled_packet<TwePacketPal>();
 	pobj->parse(p, u16len);
 	return pobj;
 }
 
+/**
+ * @fn	uint32_t TwePacketPal::_store_entry(const uint8_t* p, uint8_t u8listct, void** vars, const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList, uint8_t* pu8exListReads, uint8_t* pu8ReadDataCount)
+ *
+ * @brief	stores a sensor data into the first matching item of the list (see store_data()).
+ *
+ * @param	p	the header of the sensor data.
+ *
+ * @returns	bit 'j' is set when list[j] is stored.
+ */
+uint32_t TwePacketPal::_store_entry(const uint8_t* p, uint8_t u8listct, void** vars,
+		const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList,
+		uint8_t* pu8exListReads, uint8_t* pu8ReadDataCount) {
+	uint8_t u8dt = G_OCTET(p);
+	uint8_t u8ds = G_OCTET(p);
+	uint8_t u8ex = G_OCTET(p);
+	uint8_t u8ln = G_OCTET(p);
+
+	for (int j = 0; j < u8listct; j++) {
+		uint8_t u8ex_mask = (pu8exList[j] & 0xFF00) ? (pu8exList[j] >> 8) : 0xFF;
+		if (u8ds == pu8dsList[j] && (pu8exList[j] == 0xffff || (u8ex & u8ex_mask) == (pu8exList[j] & u8ex_mask))) {
+			if (!(u8dt & 0x80)) {
+				uint8_t u8ty = u8dt & 0x3;
+				uint8_t typ_siz = (u8ty <= 2) ? 1 << u8ty : 1;
+
+				// type check
+				if (u8ty <= 2) {
+					if (pu8argsize[j] != typ_siz) break; // type size does not match
+					if (pu8argcount_max[j] * typ_siz < u8ln) break; // buffer length does not match
+				}
+
+				// match!
+				switch (u8dt & 0x03) {
+				case 0: case 3: // char
+					for (uint8_t k = 0; k < u8ln; k++) ((uint8_t*)vars[j])[k] = G_OCTET(p);
+					if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
+					break;
+				case 1: // short 
+					for (uint8_t k = 0; k < u8ln / sizeof(uint16_t); k++) ((uint16_t*)vars[j])[k] = G_WORD(p);
+					if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
+					break;
+				case 2: // long
+					for (uint8_t k = 0; k < u8ln / sizeof(uint32_t); k++) ((uint32_t*)vars[j])[k] = G_DWORD(p);
+					if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
+					break;
+				}
+
+				if (pu8exListReads) pu8exListReads[j] = u8ex;
+
+				return 1UL << j;
+			}
+		}
+	}
+
+	return 0;
+}
+
 /**
  * @fn	uint32_t TwePacketPal::store_data(uint8_t u8listct, void** vars, const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList, uint8_t* pu8exListReads)
  *
  * @brief	parse function of sensors data, for operator >> (Pal???).
+ * 			Only the entries of the data sources in the list are visited (by the index of decode()).
  *
  * @param 		  	u8listct	   	The 8listct.
  * @param [in,out]	vars		   	If non-null, the variables.
@@ -192,65 +289,37 @@ uint32_t TwePacketPal::store_data(uint8_t u8listct, void** vars,
 		const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList,
 		uint8_t* pu8exListReads, uint8_t* pu8ReadDataCount) {
 	uint32_t u32store_mask = 0;
-	uint8_t* p = 0;
-
-	if (uptr_snsdata) {
-		p = uptr_snsdata.get();
-	}
-	else {
-		p = au8snsdata;
+	const uint8_t* pb = uptr_snsdata ? uptr_snsdata.get() : au8snsdata;
+
+	if (_u8sns_kind_ct > SNS_KIND_MAX) {
+		// not indexed, walk all the headers.
+		const uint8_t* p = pb;
+		for (int i = 0; i < u8sensors; i++) {
+			u32store_mask |= _store_entry(p, u8listct, vars, pu8argsize, pu8argcount_max, pu8dsList, pu8exList, pu8exListReads, pu8ReadDataCount);
+			p += 4 + p[3];
+		}
+		return u32store_mask;
 	}
 
-	for (int i = 0; i < u8sensors; i++) {
-		uint8_t u8dt = G_OCTET(p);
-		uint8_t u8ds = G_OCTET(p);
-		uint8_t u8ex = G_OCTET(p);
-		uint8_t u8ln = G_OCTET(p);
+	for (int j = 0; j < u8listct; j++) {
+		// each data source once
+		int j0 = 0;
+		while (j0 < j && pu8dsList[j0] != pu8dsList[j]) j0++;
+		if (j0 < j) continue;
 
-		uint8_t* pNext = p + u8ln;
-
-		for (int j = 0; j < u8listct; j++) {
-			uint32_t val = 0;
-
-			uint8_t u8ex_mask = (pu8exList[j] & 0xFF00) ? (pu8exList[j] >> 8) : 0xFF;
-			if (u8ds == pu8dsList[j] && (pu8exList[j] == 0xffff || (u8ex & u8ex_mask) == (pu8exList[j] & u8ex_mask))) {
-				if (!(u8dt & 0x80)) {
-					uint8_t u8ty = u8dt & 0x3;
-					uint8_t typ_siz = (u8ty <= 2) ? 1 << u8ty : 1;
-
-					bool bTypeErr = false;
-
-					// type check
-					if (u8ty <= 2) {
-						if (pu8argsize[j] != typ_siz) break; // type size does not match
-						if (pu8argcount_max[j] * typ_siz < u8ln) break; // buffer length does not match
-					}
-
-					// match!
-					switch (u8dt & 0x03) {
-					case 0: case 3: // char
-						for (uint8_t k = 0; k < u8ln; k++) ((uint8_t*)vars[j])[k] = G_OCTET(p);
-						if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
-						break;
-					case 1: // short 
-						for (uint8_t k = 0; k < u8ln / sizeof(uint16_t); k++) ((uint16_t*)vars[j])[k] = G_WORD(p);
-						if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
-						break;
-					case 2: // long
-						for (uint8_t k = 0; k < u8ln / sizeof(uint32_t); k++) ((uint32_t*)vars[j])[k] = G_DWORD(p);
-						if (pu8ReadDataCount) pu8ReadDataCount[j] = u8ln;
-						break;
-					}
-
-					if (pu8exListReads) pu8exListReads[j] = u8ex;
-
-					u32store_mask |= (1 << j);
-					break;
-				}
-			}
-		}
+		// find the kind
+		int k = 0;
+		while (k < _u8sns_kind_ct && _sns_kind[k].u8ds != pu8dsList[j]) k++;
+		if (k == _u8sns_kind_ct) continue;
 
-		p = pNext;
+		// from the first entry of the kind (the other kinds between them are skipped)
+		const uint8_t* p = pb + _sns_kind[k].u16off;
+		for (int ct = _sns_kind[k].u8ct; ct > 0; p += 4 + p[3]) {
+			if (p[1] != _sns_kind[k].u8ds) continue;
+
+			u32store_mask |= _store_entry(p, u8listct, vars, pu8argsize, pu8argcount_max, pu8dsList, pu8exList, pu8exListReads, pu8ReadDataCount);
+			ct--;
+		}
 	}
 
 	return u32store_mask;
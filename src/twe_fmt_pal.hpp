@@ -96,10 +96,10 @@ namespace TWEFMT {
 		};
 		uint8_t u8datafmt;		// 0:With PacketDataInfo, 1:standard data set (w/o PacketDataInfo)
 		uint8_t u8sensors;		// MSB=1:include parse error, lower bits: num of sensors
-		uint8_t u8snsdatalen;   // if set MSB, it's as dynamic allocation.
+		uint16_t u16snsdatalen; // if set MSB, it's as dynamic allocation.
 
 		uint8_t au8snsdata[32];
-		std::unique_ptr<uint8_t[]> uptr_snsdata;
+		uptr_snsbuf uptr_snsdata; // see new_snsbuf()
 
 		bool has_data_info() { return u8datafmt == 0; }
 
@@ -298,6 +298,21 @@ namespace TWEFMT {
 	};
 
 	class TwePacketPal : public TwePacket, public DataPal, public PalEvent, public PalDataInfo {
+		// index of the sensor data by kind (data source), built by decode().
+		// store_data() jumps to the first entry of the kind, instead of walking all the headers.
+		static const int SNS_KIND_MAX = 8; // if more kinds, not indexed (all the headers are walked).
+		struct _sns_kind {
+			uint16_t u16off; // offset of the first header of the kind in au8snsdata/uptr_snsdata
+			uint8_t u8ds;    // data source
+			uint8_t u8ct;    // number of the entries of the kind
+		} _sns_kind[SNS_KIND_MAX];
+		uint8_t _u8sns_kind_ct; // 0xFF: not indexed
+
+		// store an entry (p: the header) into vars[], used by store_data().
+		static uint32_t _store_entry(const uint8_t* p, uint8_t u8listct, void** vars,
+				const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList,
+				uint8_t* pu8exListReads, uint8_t* pu8ReadDataCount);
+
 		// parse each sensor data and convert into variables.
 		uint32_t store_data(uint8_t u8listct, void** vars,
 				const uint8_t* pu8argsize, const uint8_t* pu8argcount_max, const uint16_t* pu8dsList, const uint16_t* pu8exList,
@@ -309,17 +324,25 @@ namespace TWEFMT {
 	public:
 		static const E_PKT _pkt_id = E_PKT::PKT_PAL;
 
-		TwePacketPal() : TwePacket(_pkt_id), DataPal({ 0 }) { }
+		TwePacketPal() : TwePacket(_pkt_id), DataPal({ 0 }), _u8sns_kind_ct(0) { }
 		~TwePacketPal() { }
 		E_PKT parse(uint8_t* p, uint16_t len);
 
-		static inline E_PKT identify(uint8_t* p, uint8_t* e, uint16_t u16len) {
-			// TWELITE PAL
-			if (   u16len > 14 // at senser data count
+		// validates (sensor data length, CRC8) and decodes in a single pass.
+		// returns E_PKT_ERR::NONE if decoded, E_PKT_ERR::PAL_DATA if only data info/event is broken.
+		E_PKT_ERR decode(uint8_t* p, uint16_t len);
+
+		// check the fixed part of the header (the sensor data and CRC are not checked).
+		static inline bool identify_header(uint8_t* p, uint16_t u16len) {
+			return u16len > 14 // at senser data count
 				&& p[0] & 0x80 // 
 				&& p[7] & 0x80
-				&& p[12] == 0x80
-				) {
+				&& p[12] == 0x80;
+		}
+
+		static inline E_PKT identify(uint8_t* p, uint8_t* e, uint16_t u16len) {
+			// TWELITE PAL
+			if (identify_header(p, u16len)) {
 				// check sensor data part
 				uint8_t u8ct = p[14], * ps0 = &p[15], * ps = ps0;
 				uint8_t u8Sensors = 0;
@@ -337,7 +360,7 @@ namespace TWEFMT {
 				if (u8ct == u8Sensors) {
 					if (e > ps) {
 						// CRC
-						uint8_t u8crc = TWEUTILS::CRC8_u8Calc(p, uint8_t(ps - p));
+						uint8_t u8crc = TWEUTILS::CRC8_u8Calc(p, size_t(ps - p));
 
 						if (u8crc == *ps) { // match CRC8
 							// accept
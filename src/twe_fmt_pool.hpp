@@ -0,0 +1,166 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include "twe_common.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace TWEFMT {
+	/**
+	 * @class	PacketBlockPool
+	 *
+	 * @brief	Free list of fixed size blocks, used for the decoded packet objects
+	 * 			and their sensor data buffers (see newTwePacket()).
+	 * 			It grows by a chunk of blocks when empty and never returns the memory
+	 * 			to the heap, then the steady state ingest has no heap allocation.
+	 * 			alloc()/free() can be called from any thread (short spin lock).
+	 */
+	class PacketBlockPool {
+		union _block {
+			_block* next;
+			std::max_align_t _align;
+		};
+
+		const size_t _blk_size;  // block size (multiple of sizeof(_block))
+		const uint16_t _n_grow;  // number of blocks added at once
+		_block* _free;           // free list
+		std::atomic_flag _lock;
+		uint32_t _u32blocks;     // number of blocks allocated from heap
+
+		// add a chunk (lock is held)
+		void _grow() {
+			size_t units = _blk_size / sizeof(_block);
+			_block* chunk = static_cast<_block*>(::operator new(_blk_size * _n_grow));
+			for (uint16_t i = 0; i < _n_grow; i++) {
+				_block* b = chunk + i * units;
+				b->next = _free;
+				_free = b;
+			}
+			_u32blocks += _n_grow;
+		}
+
+		inline void _acquire() { while (_lock.test_and_set(std::memory_order_acquire)) {} }
+		inline void _release() { _lock.clear(std::memory_order_release); }
+
+	public:
+		PacketBlockPool(size_t blk_size, uint16_t n_grow = 16)
+			: _blk_size(((blk_size + sizeof(_block) - 1) / sizeof(_block)) * sizeof(_block))
+			, _n_grow(n_grow), _free(nullptr), _lock(), _u32blocks(0)
+		{
+			_lock.clear();
+		}
+
+		PacketBlockPool(const PacketBlockPool&) = delete;
+
+		// get a block (size is block_size())
+		void* alloc() {
+			_acquire();
+			if (_free == nullptr) _grow();
+			_block* b = _free;
+			_free = b->next;
+			_release();
+			return b;
+		}
+
+		// return a block from alloc()
+		void free(void* p) {
+			_block* b = static_cast<_block*>(p);
+			_acquire();
+			b->next = _free;
+			_free = b;
+			_release();
+		}
+
+		inline size_t block_size() const { return _blk_size; }
+		inline uint32_t blocks() const { return _u32blocks; }
+
+		// the pool of the size class (blocks of N * 32 bytes).
+		// it is never destroyed, as packets may be released on exit after static objects.
+		template <size_t N>
+		static PacketBlockPool& of_class() {
+			static PacketBlockPool& pool = *new PacketBlockPool(N * 32);
+			return pool;
+		}
+
+		// the pool for the object of SIZ bytes.
+		template <size_t SIZ>
+		static inline PacketBlockPool& of_size() { return of_class<(SIZ + 31) / 32>(); }
+	};
+
+	/**
+	 * @class	PacketAllocator
+	 *
+	 * @brief	Allocator for std::allocate_shared(), the object and its reference
+	 * 			counter are stored in one block of PacketBlockPool.
+	 */
+	template <class T>
+	struct PacketAllocator {
+		typedef T value_type;
+
+		PacketAllocator() noexcept {}
+		template <class U> PacketAllocator(const PacketAllocator<U>&) noexcept {}
+
+		T* allocate(size_t n) {
+			if (n == 1) return static_cast<T*>(PacketBlockPool::of_size<sizeof(T)>().alloc());
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, size_t n) noexcept {
+			if (n == 1) PacketBlockPool::of_size<sizeof(T)>().free(p);
+			else ::operator delete(p);
+		}
+
+		template <class U> bool operator == (const PacketAllocator<U>&) const noexcept { return true; }
+		template <class U> bool operator != (const PacketAllocator<U>&) const noexcept { return false; }
+	};
+
+	// create a packet object of T from the pool.
+	template <class T>
+	inline std::shared_ptr<T> make_pooled_packet() {
+		return std::allocate_shared<T>(PacketAllocator<T>());
+	}
+
+	/**
+	 * @class	SnsBufDeleter
+	 *
+	 * @brief	Deleter of the sensor data buffer from new_snsbuf().
+	 * 			The buffers up to 1024 bytes are in the pools of 64, 128, ... 1024 bytes.
+	 */
+	struct SnsBufDeleter {
+		static const uint8_t CLS_HEAP = 0xFF;
+		uint8_t _cls; // size class (64 << _cls bytes), CLS_HEAP: new[]
+
+		SnsBufDeleter(uint8_t cls = CLS_HEAP) noexcept : _cls(cls) {}
+
+		static PacketBlockPool& pool(uint8_t cls) {
+			switch (cls) {
+			case 0: return PacketBlockPool::of_size<64>();
+			case 1: return PacketBlockPool::of_size<128>();
+			case 2: return PacketBlockPool::of_size<256>();
+			case 3: return PacketBlockPool::of_size<512>();
+			default: return PacketBlockPool::of_size<1024>();
+			}
+		}
+
+		void operator()(uint8_t* p) const noexcept {
+			if (_cls == CLS_HEAP) delete[] p;
+			else pool(_cls).free(p);
+		}
+	};
+	typedef std::unique_ptr<uint8_t[], SnsBufDeleter> uptr_snsbuf;
+
+	// allocate a sensor data buffer of len bytes.
+	static inline uptr_snsbuf new_snsbuf(size_t len) {
+		for (uint8_t cls = 0; cls <= 4; cls++) {
+			if (len <= (size_t(64) << cls)) {
+				return uptr_snsbuf(static_cast<uint8_t*>(SnsBufDeleter::pool(cls).alloc()), SnsBufDeleter(cls));
+			}
+		}
+		return uptr_snsbuf(new uint8_t[len], SnsBufDeleter());
+	}
+}
@@ -0,0 +1,327 @@
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include <string.h>
+#include "twe_fmt.hpp"
+#include "twe_fmt_record.hpp"
+
+using namespace TWEFMT;
+using namespace TWEUTILS;
+
+/**
+ * @fn	void PacketRecord::clear()
+ *
+ * @brief	Clears all fields, and set the version.
+ */
+void PacketRecord::clear() {
+	memset(this, 0, sizeof(PacketRecord));
+	u8version = VERSION;
+}
+
+/**
+ * @fn	PacketRecord::Value* PacketRecord::add_value(E_REC_VAL kind, uint8_t idx, int16_t v0, int16_t v1, int16_t v2)
+ *
+ * @brief	Adds a value.
+ *
+ * @param	kind	The kind.
+ * @param	idx 	The index (channel, sample number, ...).
+ * @param	v0  	The value 0.
+ * @param	v1  	The value 1.
+ * @param	v2  	The value 2.
+ *
+ * @returns	the added value, nullptr if full (FLAG_VALUES_TRUNCATED is set).
+ */
+PacketRecord::Value* PacketRecord::add_value(E_REC_VAL kind, uint8_t idx, int16_t v0, int16_t v1, int16_t v2) {
+	if (u8values >= MAX_VALUES) {
+		u8flags |= FLAG_VALUES_TRUNCATED;
+		return nullptr;
+	}
+
+	Value& v = values[u8values++];
+	v.u8kind = uint8_t(kind);
+	v.u8idx = idx;
+	v.v[0] = v0;
+	v.v[1] = v1;
+	v.v[2] = v2;
+	return &v;
+}
+
+/**
+ * @fn	const PacketRecord::Value* PacketRecord::find_value(E_REC_VAL kind, int idx) const
+ *
+ * @brief	Searches for the first value of the kind.
+ *
+ * @param	kind	The kind.
+ * @param	idx 	The index, any if negative.
+ *
+ * @returns	the value, nullptr if not found.
+ */
+const PacketRecord::Value* PacketRecord::find_value(E_REC_VAL kind, int idx) const {
+	for (int i = 0; i < u8values; i++) {
+		if (values[i].kind() == kind && (idx < 0 || values[i].u8idx == idx)) return &values[i];
+	}
+	return nullptr;
+}
+
+/**
+ * @fn	void PacketRecord::set_data(const uint8_t* p, size_t len)
+ *
+ * @brief	Stores raw payload (truncated to MAX_DATA).
+ *
+ * @param	p  	The payload.
+ * @param	len	The length.
+ */
+void PacketRecord::set_data(const uint8_t* p, size_t len) {
+	if (len > size_t(MAX_DATA)) {
+		len = MAX_DATA;
+		u8flags |= FLAG_DATA_TRUNCATED;
+	}
+	if (len) memcpy(au8data, p, len);
+	u16datalen = uint16_t(len);
+}
+
+/**
+ * @fn	size_t PacketRecord::serialize(uint8_t* p, size_t siz) const
+ *
+ * @brief	Serializes the record (big endian).
+ * 			[header 32bytes] [value 8bytes x u8values] [data u16datalen bytes]
+ *
+ * @param [out]	p  	the buffer.
+ * @param 	   	siz	the size of the buffer.
+ *
+ * @returns	written bytes, 0 if the buffer is short.
+ */
+size_t PacketRecord::serialize(uint8_t* p, size_t siz) const {
+	size_t len = serialized_size();
+	if (siz < len) return 0;
+
+	uint8_t* q = p;
+	S_OCTET(q, VERSION);
+	S_OCTET(q, u8type);
+	S_OCTET(q, u8subtype);
+	S_OCTET(q, u8flags);
+	S_DWORD(q, u32tick);
+	S_DWORD(q, u32addr_src);
+	S_DWORD(q, u32addr_dst);
+	S_DWORD(q, u32addr_rpt);
+	S_WORD(q, u16seq);
+	S_WORD(q, u16volt);
+	S_OCTET(q, u8addr_src);
+	S_OCTET(q, u8addr_dst);
+	S_OCTET(q, u8lqi);
+	S_OCTET(q, u8port);
+	S_OCTET(q, u8rpt_cnt);
+	S_OCTET(q, u8values);
+	S_WORD(q, u16datalen);
+
+	for (int i = 0; i < u8values; i++) {
+		const Value& v = values[i];
+		S_OCTET(q, v.u8kind);
+		S_OCTET(q, v.u8idx);
+		S_WORD(q, uint16_t(v.v[0]));
+		S_WORD(q, uint16_t(v.v[1]));
+		S_WORD(q, uint16_t(v.v[2]));
+	}
+
+	memcpy(q, au8data, u16datalen);
+	return len;
+}
+
+/**
+ * @fn	size_t PacketRecord::deserialize(const uint8_t* p, size_t len)
+ *
+ * @brief	Deserializes the record from serialize() output.
+ *
+ * @param	p  	the byte sequence.
+ * @param	len	the length.
+ *
+ * @returns	read bytes, 0 if broken, short or unsupported version.
+ */
+size_t PacketRecord::deserialize(const uint8_t* p, size_t len) {
+	if (len < SER_HEADER_SIZE || p[0] != VERSION) return 0;
+
+	// check the length first (keep this object if failed).
+	uint8_t n_values = p[29];
+	uint16_t datalen = uint16_t(p[30] << 8 | p[31]);
+	size_t siz = SER_HEADER_SIZE + n_values * SER_VALUE_SIZE + datalen;
+	if (n_values > MAX_VALUES || datalen > MAX_DATA || len < siz) return 0;
+
+	clear();
+
+	const uint8_t* q = p + 1;
+	u8type = G_OCTET(q);
+	u8subtype = G_OCTET(q);
+	u8flags = G_OCTET(q);
+	u32tick = G_DWORD(q);
+	u32addr_src = G_DWORD(q);
+	u32addr_dst = G_DWORD(q);
+	u32addr_rpt = G_DWORD(q);
+	u16seq = G_WORD(q);
+	u16volt = G_WORD(q);
+	u8addr_src = G_OCTET(q);
+	u8addr_dst = G_OCTET(q);
+	u8lqi = G_OCTET(q);
+	u8port = G_OCTET(q);
+	u8rpt_cnt = G_OCTET(q);
+	u8values = G_OCTET(q);
+	u16datalen = G_WORD(q);
+
+	for (int i = 0; i < u8values; i++) {
+		Value& v = values[i];
+		v.u8kind = G_OCTET(q);
+		v.u8idx = G_OCTET(q);
+		v.v[0] = int16_t(G_WORD(q));
+		v.v[1] = int16_t(G_WORD(q));
+		v.v[2] = int16_t(G_WORD(q));
+	}
+
+	memcpy(au8data, q, u16datalen);
+	return siz;
+}
+
+// values of the PAL packet (by board type)
+static void _pal_values(TwePacketPal& pal, PacketRecord& rec) {
+	switch (pal.e_board) {
+	case E_PAL_PCB::MAG: {
+		PalMag d = pal.get_PalMag();
+		if (d.u32StoredMask & 1) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		if (d.u32StoredMask & 2) rec.add_value(E_REC_VAL::MAG, 0, d.u8MagStat, d.bRegularTransmit);
+	} break;
+
+	case E_PAL_PCB::AMB: {
+		PalAmb d = pal.get_PalAmb();
+		if (d.u32StoredMask & 1) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_TEMP) rec.add_value(E_REC_VAL::TEMP, 0, d.i16Temp);
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_HUMID) rec.add_value(E_REC_VAL::HUMID, 0, int16_t(d.u16Humd));
+		if (d.u32StoredMask & PalAmb::STORE_VOLT_LUMI) {
+			if (auto v = rec.add_value(E_REC_VAL::LUMI)) v->set_i32(int32_t(d.u32Lumi));
+		}
+	} break;
+
+	case E_PAL_PCB::MOT: {
+		PalMot d = pal.get_PalMot();
+		if (d.u32StoredMask & PalMot::STORE_VOLT_MASK) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		if (d.u8samples) rec.add_value(E_REC_VAL::SAMPLE_RATE, 0, d.u8sample_rate_code);
+		for (int i = 0; i < d.u8samples; i++) {
+			rec.add_value(E_REC_VAL::ACCEL, uint8_t(i), d.i16X[i], d.i16Y[i], d.i16Z[i]);
+		}
+	} break;
+
+	case E_PAL_PCB::CUE: {
+		TweCUE d = pal.get_TweCUE();
+		if (d.u32StoredMask & TweCUE::STORE_VOLT_MASK) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		if (d.u32StoredMask & TweCUE::STORE_ADC1_MASK) rec.add_value(E_REC_VAL::ADC, 1, int16_t(d.u16Adc1));
+		if (d.u32StoredMask & TweCUE::STORE_MAG_MASK) rec.add_value(E_REC_VAL::MAG, 0, d.u8MagStat, d.bMagRegularTransmit);
+		if (d.u8samples) rec.add_value(E_REC_VAL::SAMPLE_RATE, 0, d.u8sample_rate_code);
+		for (int i = 0; i < d.u8samples; i++) {
+			rec.add_value(E_REC_VAL::ACCEL, uint8_t(i), d.i16X[i], d.i16Y[i], d.i16Z[i]);
+		}
+	} break;
+
+	case E_PAL_PCB::ARIA: {
+		TweARIA d = pal.get_TweARIA();
+		if (d.u32StoredMask & TweARIA::STORE_VOLT_MASK) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		if (d.u32StoredMask & TweARIA::STORE_ADC1_MASK) rec.add_value(E_REC_VAL::ADC, 1, int16_t(d.u16Adc1));
+		if (d.u32StoredMask & TweARIA::STORE_MAG_MASK) rec.add_value(E_REC_VAL::MAG, 0, d.u8MagStat, d.bMagRegularTransmit);
+		if (d.u32StoredMask & TweARIA::STORE_VOLT_TEMP) rec.add_value(E_REC_VAL::TEMP, 0, d.i16Temp);
+		if (d.u32StoredMask & TweARIA::STORE_VOLT_HUMID) rec.add_value(E_REC_VAL::HUMID, 0, int16_t(d.u16Humd));
+	} break;
+
+	default: {
+		// unsupported board, store the sensor data as is.
+		uint16_t len = pal.u16snsdatalen & 0x7FFF;
+		rec.set_data(pal.uptr_snsdata ? pal.uptr_snsdata.get() : pal.au8snsdata, len);
+		if (pal.common.volt) rec.add_value(E_REC_VAL::VOLT, 0, int16_t(pal.common.volt));
+	} break;
+	}
+
+	if (pal.has_data_info()) {
+		rec.add_value(E_REC_VAL::DATA_INFO, pal.u8data_type, pal.u8_data_source, pal.u8_data_cause);
+	}
+
+	if (pal.has_PalEvent()) {
+		PalEvent& ev = pal.get_PalEvent();
+		if (auto v = rec.add_value(E_REC_VAL::EVENT, ev.u8event_source)) {
+			v->set_i32(int32_t((uint32_t(ev.u8event_id) << 24) | (ev.u32event_param & 0x00FFFFFF)));
+		}
+	}
+}
+
+/**
+ * @fn	bool TWEFMT::make_packet_record(TwePacket& pkt, PacketRecord& rec)
+ *
+ * @brief	Converts the packet object into PacketRecord.
+ *
+ * @param [in]	pkt	The packet.
+ * @param [out]	rec	The record.
+ *
+ * @returns	True if it succeeds, false if the packet type is not supported.
+ */
+bool TWEFMT::make_packet_record(TwePacket& pkt, PacketRecord& rec) {
+	rec.clear();
+
+	rec.u8type = uint8_t(pkt.get_type());
+	rec.u32tick = pkt.common.tick;
+	rec.u32addr_src = pkt.common.src_addr;
+	rec.u8addr_src = pkt.common.src_lid;
+	rec.u8lqi = pkt.common.lqi;
+	rec.u16volt = pkt.common.volt;
+	rec.u8port = pkt.common.port;
+
+	switch (pkt.get_type()) {
+	case E_PKT::PKT_TWELITE: {
+		auto& d = static_cast<TwePacketTwelite&>(pkt);
+		rec.u8addr_dst = d.u8addr_dst;
+		rec.u16seq = d.u16timestamp;
+		rec.u8rpt_cnt = d.u8rpt_cnt;
+		rec.u16volt = d.u16Volt;
+
+		rec.add_value(E_REC_VAL::VOLT, 0, int16_t(d.u16Volt));
+		rec.add_value(E_REC_VAL::DI, 0, d.DI_mask, d.DI_active_mask);
+		const uint16_t adc[] = { d.u16Adc1, d.u16Adc2, d.u16Adc3, d.u16Adc4 };
+		for (int i = 0; i < 4; i++) {
+			if (d.Adc_active_mask & (1 << i)) rec.add_value(E_REC_VAL::ADC, uint8_t(i + 1), int16_t(adc[i]));
+		}
+	} break;
+
+	case E_PKT::PKT_APPIO: {
+		auto& d = static_cast<TwePacketAppIO&>(pkt);
+		rec.u8addr_dst = d.u8addr_dst;
+		rec.u16seq = d.u16timestamp;
+		rec.u8rpt_cnt = d.u8rpt_cnt;
+
+		rec.add_value(E_REC_VAL::DI, 0, int16_t(d.DI_mask), int16_t(d.DI_active_mask), int16_t(d.DI_int_mask));
+	} break;
+
+	case E_PKT::PKT_APPUART:
+	case E_PKT::PKT_ACT_STD: {
+		auto& d = static_cast<TwePacketAppUART&>(pkt);
+		rec.u8subtype = d.u8response_id;
+		rec.u32addr_dst = d.u32addr_dst;
+		rec.u8addr_dst = d.u8addr_dst;
+		rec.set_data(d.payload.data(), d.payload.length());
+	} break;
+
+	case E_PKT::PKT_APPTAG: {
+		auto& d = static_cast<TwePacketAppTAG&>(pkt);
+		rec.u8subtype = d.u8sns;
+		rec.u32addr_rpt = d.u32addr_rpt;
+		rec.u16seq = d.u16seq;
+		rec.u16volt = d.u16Volt;
+		rec.set_data(d.payload.data(), d.payload.length());
+	} break;
+
+	case E_PKT::PKT_PAL: {
+		auto& d = static_cast<TwePacketPal&>(pkt);
+		rec.u8subtype = d.u8board;
+		rec.u32addr_rpt = d.u32addr_rpt;
+		rec.u16seq = d.u16seq;
+		_pal_values(d, rec);
+	} break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
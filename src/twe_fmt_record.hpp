@@ -0,0 +1,129 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+/*****************************************************
+ * PACKET RECORD
+ *   fixed layout (trivially copyable) form of the decoded
+ *   packets, for ring buffers, files and shared memory.
+ *****************************************************/
+
+#include "twe_fmt_common.hpp"
+
+#include <type_traits>
+
+namespace TWEFMT {
+	// kind of PacketRecord::Value
+	enum class E_REC_VAL : uint8_t {
+		NONE = 0,
+		VOLT,        // module voltage [mV] (v[0])
+		ADC,         // ADC voltage [mV] (v[0]), idx: channel (1..4)
+		TEMP,        // temperature [100x degC] (v[0])
+		HUMID,       // humidity [100x %] (v[0])
+		LUMI,        // luminance [lux] (get_i32())
+		ACCEL,       // acceleration [mG] (v[0..2]: X,Y,Z), idx: sample number
+		SAMPLE_RATE, // sample rate code of ACCEL (v[0], 0:25Hz 4:100Hz)
+		MAG,         // magnet sensor state (v[0]), v[1]: 1 if regular transmit
+		DI,          // digital inputs (v[0]: state mask, v[1]: active mask, v[2]: interrupt mask)
+		EVENT,       // PAL event (get_i32(): id << 24 | param), idx: event source
+		DATA_INFO    // PAL data info (v[0]: source, v[1]: cause), idx: data type
+	};
+
+	/**
+	 * @struct	PacketRecord
+	 *
+	 * @brief	A decoded packet in the fixed layout (no pointer, trivially copyable).
+	 * 			The common fields are in the header, the sensor values follow as typed values,
+	 * 			and the raw payload of App UART, Act and App TAG (or PAL sensor data
+	 * 			of an unsupported board) is stored into au8data.
+	 *
+	 * 			make_packet_record() converts from TwePacket objects,
+	 * 			serialize()/deserialize() give versioned byte sequences (big endian),
+	 * 			where only u8values and u16datalen bytes are stored.
+	 */
+	struct PacketRecord {
+		static const uint8_t VERSION = 1;
+		static const int MAX_VALUES = 32;
+		static const int MAX_DATA = 128;
+
+		// u8flags
+		static const uint8_t FLAG_VALUES_TRUNCATED = 0x01; // more values than MAX_VALUES
+		static const uint8_t FLAG_DATA_TRUNCATED = 0x02;   // the payload is longer than MAX_DATA
+
+		// the size of serialized header and a value.
+		static const size_t SER_HEADER_SIZE = 32;
+		static const size_t SER_VALUE_SIZE = 8;
+
+		struct Value {
+			uint8_t u8kind; // E_REC_VAL
+			uint8_t u8idx;  // index (channel, sample number, ...)
+			int16_t v[3];
+
+			inline E_REC_VAL kind() const { return E_REC_VAL(u8kind); }
+			inline int32_t get_i32() const { return int32_t(uint32_t(uint16_t(v[0])) | (uint32_t(uint16_t(v[1])) << 16)); }
+			inline void set_i32(int32_t i) { v[0] = int16_t(i & 0xFFFF); v[1] = int16_t(uint32_t(i) >> 16); v[2] = 0; }
+		};
+
+		// header
+		uint8_t u8version;    // VERSION
+		uint8_t u8type;       // E_PKT
+		uint8_t u8subtype;    // PAL: board id (E_PAL_PCB), App UART/Act: response id, App TAG: sensor type
+		uint8_t u8flags;      // FLAG_???
+
+		uint32_t u32tick;     // common.tick
+		uint32_t u32addr_src; // source address (Serial ID)
+		uint32_t u32addr_dst; // destination address (Serial ID, App UART/Act)
+		uint32_t u32addr_rpt; // repeater address (PAL/App TAG, 0x80000000: direct)
+
+		uint16_t u16seq;      // sequence number or time stamp
+		uint16_t u16volt;     // module voltage [mV] (0: unknown)
+
+		uint8_t u8addr_src;   // source address (logical ID)
+		uint8_t u8addr_dst;   // destination address (logical ID)
+		uint8_t u8lqi;        // LQI
+		uint8_t u8port;       // source port index (see SerialMulti)
+
+		uint8_t u8rpt_cnt;    // repeat count (App Twelite/IO)
+		uint8_t u8values;     // count of values
+		uint16_t u16datalen;  // length of au8data
+
+		// typed values
+		Value values[MAX_VALUES];
+
+		// raw payload
+		uint8_t au8data[MAX_DATA];
+
+		inline E_PKT type() const { return E_PKT(u8type); }
+
+		// clear all fields (version is set)
+		void clear();
+
+		// add a value, returns nullptr if it's full (FLAG_VALUES_TRUNCATED is set).
+		Value* add_value(E_REC_VAL kind, uint8_t idx = 0, int16_t v0 = 0, int16_t v1 = 0, int16_t v2 = 0);
+
+		// find the first value of the kind (and idx if idx >= 0).
+		const Value* find_value(E_REC_VAL kind, int idx = -1) const;
+
+		// store raw payload (truncated to MAX_DATA, FLAG_DATA_TRUNCATED is set)
+		void set_data(const uint8_t* p, size_t len);
+
+		// the size of serialize() output.
+		inline size_t serialized_size() const { return SER_HEADER_SIZE + u8values * SER_VALUE_SIZE + u16datalen; }
+
+		// write into p (siz bytes at most), returns written bytes (0: short buffer).
+		size_t serialize(uint8_t* p, size_t siz) const;
+
+		// read from p (len bytes), returns read bytes (0: broken, short or unsupported version).
+		size_t deserialize(const uint8_t* p, size_t len);
+	};
+
+	static_assert(std::is_trivially_copyable<PacketRecord>::value, "PacketRecord must be trivially copyable.");
+
+	// convert the packet object into the record, returns false if the packet type is not supported.
+	bool make_packet_record(TwePacket& pkt, PacketRecord& rec);
+	static inline bool make_packet_record(spTwePacket& pkt, PacketRecord& rec) {
+		if (!pkt) { rec.clear(); return false; }
+		return make_packet_record(*pkt, rec);
+	}
+}
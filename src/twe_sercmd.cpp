@@ -9,9 +9,10 @@
 
  // uart input queue
 #ifndef ESP32
-TWEUTILS::InputQueue<uint8_t, true> the_uart_queue(4096);
+TWE_UART_QUEUE_TYPE the_uart_queue(4096);
 #else
-TWEUTILS::InputQueue<uint8_t, false> the_uart_queue(512);
+TWE_UART_QUEUE_TYPE the_uart_queue(512);
 #endif
+TWESERCMD::IParser* the_uart_parser = nullptr;
 
 // nothing implemented so far
\ No newline at end of file
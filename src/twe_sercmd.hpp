@@ -54,6 +54,28 @@
 #endif
 
 #include "twe_utils_fixedque.hpp"
+#include "twe_sercmd_framepool.hpp"
+
+#if defined(TWE_STDINOUT_ONLY)
+# ifdef TWE_HAS_MILLIS
+extern uint32_t millis();
+# else
+#define millis() (0)
+# endif
+namespace TWESYS {
+	// Dummy TimeOut class
+	struct TimeOut {
+		void start() {}
+		void start_at(uint32_t) {}
+		void stop() {}
+		bool is_timeout() { return false; }
+		bool is_timeout_at(uint32_t) { return false; }
+		bool is_enabled() { return false; }
+	};
+}
+#else
+#include "twe_sys.hpp"
+#endif
 
 namespace TWESERCMD {
 	/// <summary>
@@ -67,6 +89,15 @@ namespace TWESERCMD {
 		E_TWESERCMD_CHECKSUM_ERROR = 0x82,   //!< チェックサムが間違っている
 	} teSerCmdGenState;
 
+	/// <summary>
+	/// パーサーの統計情報 (IParser::get_stats())
+	/// </summary>
+	struct ParserStats {
+		uint32_t u32frames;       //!< 完結した系列数
+		uint32_t u32errors;       //!< 入力エラー数
+		uint32_t u32cksum_errors; //!< チェックサムエラー数
+	};
+
 	/// <summary>
 	/// シリアルコマンドパーサーの基底クラス
 	/// </summary>
@@ -77,12 +108,43 @@ namespace TWESERCMD {
 		uint8_t u8state; //!< 状態
 		uint8_t bDynamic;
 		TWEUTILS::SmplBuf_Byte& payload; //!< バッファ
+		uint32_t _u32tick_rx; //!< 入力中のバイト列の到着時刻 (0:不明)
+		uint32_t _u32tick_frame; //!< 系列先頭(':' や 0xA5)の到着時刻 (0:不明)
+		ParserStats _stats; //!< 統計情報
+		FramePool* _frame_pool; //!< 完結した系列の格納先 (nullptr:使用しない)
+
+		// 状態に応じた計数と、完結した系列の FramePool への格納
+		inline void _on_state(uint8_t s) {
+			switch (s) {
+			case E_TWESERCMD_COMPLETE:
+				_stats.u32frames++;
+				if (_frame_pool) _frame_pool->push(payload.data(), payload.length(), _u32tick_frame);
+				break;
+			case E_TWESERCMD_ERROR: _stats.u32errors++; break;
+			case E_TWESERCMD_CHECKSUM_ERROR: _stats.u32cksum_errors++; break;
+			default: break;
+			}
+		}
 		
 		inline void _init() {
 			payload.redim(0);
 			u8state = E_TWESERCMD_EMPTY;
 		}
 
+		/// <summary>
+		/// 受信途中の系列がタイムアウトしていれば破棄する (派生クラスの check_timeout() 用)
+		/// </summary>
+		/// <param name="tmo">系列開始時に開始したタイマー</param>
+		/// <param name="now">チャンクの到着時刻か現在時刻</param>
+		/// <returns>破棄したら true</returns>
+		inline bool _discard_on_timeout(TWESYS::TimeOut& tmo, uint32_t now) {
+			if (u8state != E_TWESERCMD_EMPTY && u8state < 0x80 && tmo.is_timeout_at(now)) {
+				u8state = E_TWESERCMD_EMPTY; // discard the partial frame.
+				return true;
+			}
+			return false;
+		}
+
 		/// <summary>
 		/// 文字列パースの仮想関数（１バイト読み込み完了したら complete 状態になる）
 		/// </summary>
@@ -102,12 +164,14 @@ namespace TWESERCMD {
 		IParser(size_t siz) :
 			payload(*new TWEUTILS::SmplBuf_Byte(uint16_t(siz))),
 			bDynamic(true),
-			u8state(E_TWESERCMD_EMPTY) { }
+			u8state(E_TWESERCMD_EMPTY),
+			_u32tick_rx(0), _u32tick_frame(0), _stats(), _frame_pool(nullptr) { }
 
 		IParser(TWEUTILS::SmplBuf_Byte& bobj) :
 			payload(bobj), 
 			bDynamic(false),
-			u8state(E_TWESERCMD_EMPTY)
+			u8state(E_TWESERCMD_EMPTY),
+			_u32tick_rx(0), _u32tick_frame(0), _stats(), _frame_pool(nullptr)
 		{
 			payload.redim(0);
 		}
@@ -158,12 +222,40 @@ namespace TWESERCMD {
 		inline TWEUTILS::SmplBuf_Byte& get_payload() { return payload; }
 
 		// public interface
-		inline IParser& Parse(uint8_t u8b) { _u8Parse(u8b); return *this; }
+		inline IParser& Parse(uint8_t u8b) { _on_state(_u8Parse(u8b)); return *this; }
+
+		// set arrival tick of the bytes to be parsed next (0: unknown)
+		inline void set_tick(uint32_t u32tick) { _u32tick_rx = u32tick; }
+
+		// check the timeout of the partial frame, call it once per received chunk before parsing it
+		// (the parser does not read the clock per byte). now is the arrival tick of the chunk or
+		// the current tick (0: read the clock if the timer runs). returns true if the frame is discarded.
+		virtual bool check_timeout(uint32_t /*now*/) { return false; }
+		// get arrival tick of the frame start (0: unknown)
+		inline uint32_t get_tick() { return _u32tick_frame; }
+
+		// get counters of completed/errored frames (counted by Parse())
+		inline const ParserStats& get_stats() const { return _stats; }
+		inline void reset_stats() { _stats = ParserStats(); }
+
+		// set the pool where completed frames are stored (nullptr: not used).
+		// the frames are kept after the following Parse(), see FramePool::pop().
+		inline void set_frame_pool(FramePool* pool) { _frame_pool = pool; }
+		inline FramePool* get_frame_pool() { return _frame_pool; }
 
 		// re-init
 		inline virtual void reinit() = 0;
 	};
 
+	/// <summary>
+	/// 固定長ペイロードバッファ (AsciiParserT<N> 等の内部用)
+	/// IParser はコンストラクタでバッファを参照するため、IParser より先に継承して先に構築する。
+	/// </summary>
+	template <int N>
+	struct _ParserBufferL {
+		TWEUTILS::SmplBuf_ByteL<N> _buf_payload;
+	};
+
 	inline TWE::IStreamOut& operator << (TWE::IStreamOut& lhs, IParser& rhs) {
 		rhs.operator>>(lhs);
 		return lhs;
@@ -178,7 +270,13 @@ namespace TWESERCMD {
 }
 
 #ifndef ESP32
-extern TWEUTILS::InputQueue<uint8_t, true> the_uart_queue;
+// the serial update path is the only producer and the app loop is the only consumer,
+// then lock-free SPSC ring buffer is used.
+typedef TWEUTILS::InputQueue<uint8_t, false, TWEUTILS::SpscQueue<uint8_t>> TWE_UART_QUEUE_TYPE;
 #else
-extern TWEUTILS::InputQueue<uint8_t, false> the_uart_queue;
+typedef TWEUTILS::InputQueue<uint8_t, false> TWE_UART_QUEUE_TYPE;
 #endif
+extern TWE_UART_QUEUE_TYPE the_uart_queue;
+
+// the parser of the_uart_queue in the running app (nullptr: none), the counters are shown with the receive stats.
+extern TWESERCMD::IParser* the_uart_parser;
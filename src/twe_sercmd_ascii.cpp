@@ -6,127 +6,104 @@
 #include "twe_sercmd.hpp"
 #include "twe_sercmd_ascii.hpp"
 
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define TWESERCMD_ASCII_HEX_SSE2
+# include <emmintrin.h>
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+# define TWESERCMD_ASCII_HEX_NEON
+# include <arm_neon.h>
+#endif
+
 using namespace TWE;
 using namespace TWESERCMD;
 using namespace TWEUTILS;
 
-namespace TWESERCMD {
-	typedef enum {
-		E_SERCMD_ASCII_CMD_EMPTY = 0,      //!< 入力されていない
-		E_SERCMD_ASCII_CMD_READCOLON,      //!< E_SERCMD_ASCII_CMD_READCOLON
-		E_SERCMD_ASCII_CMD_READPAYLOAD,    //!< E_SERCMD_ASCII_CMD_READPAYLOAD
-		E_SERCMD_ASCII_CMD_READCR,         //!< E_SERCMD_ASCII_CMD_READCR
-		E_SERCMD_ASCII_CMD_READLF,         //!< E_SERCMD_ASCII_CMD_READLF
-		E_SERCMD_ASCII_CMD_COMPLETE = 0x80,//!< 入力が完結した(LCRチェックを含め)
-		E_SERCMD_ASCII_CMD_ERROR = 0x81,          //!< 入力エラー
-		E_SERCMD_ASCII_CMD_CHECKSUM_ERROR = 0x82,       //!< LRCが間違っている
-	} teSercmdAsciiState;
-}
-
 /// <summary>
-/// ASCII形式のパース
+/// 16進文字の変換表 (大文字のみ, 0xFF:16進文字ではない)
 /// </summary>
-/// <param name="u8byte"></param>
-/// <returns></returns>
-uint8_t AsciiParser::_u8Parse(uint8_t u8byte) {
-	// check for timeout
-	if (TimeOut::is_enabled() && TimeOut::is_timeout()) {
-		u8state = E_SERCMD_ASCII_CMD_EMPTY;
+static struct _hex_lut {
+	uint8_t v[256];
+	_hex_lut() {
+		memset(v, 0xFF, sizeof(v));
+		for (int i = 0; i < 10; i++) v['0' + i] = uint8_t(i);
+		for (int i = 0; i < 6; i++) v['A' + i] = uint8_t(10 + i);
 	}
+} s_hex_lut;
 
-	// check for complete or error status
-	if (u8state >= 0x80) {
-		u8state = E_SERCMD_ASCII_CMD_EMPTY;
+/// <summary>
+/// 16進文字列のバイト列への変換（スカラー版）
+/// </summary>
+/// <param name="s">16進文字列 (2*n_max 文字以上)</param>
+/// <param name="n_max">変換する最大バイト数</param>
+/// <param name="out">出力先</param>
+/// <param name="sum">出力バイトの和 (LRC計算用, 加算する)</param>
+/// <returns>変換したバイト数（16進文字以外があればその手前まで）</returns>
+static size_t s_hex_decode_scalar(const uint8_t* s, size_t n_max, uint8_t* out, uint8_t& sum) {
+	size_t i = 0;
+	for (; i < n_max; i++) {
+		uint8_t h = s_hex_lut.v[s[2 * i]];
+		uint8_t l = s_hex_lut.v[s[2 * i + 1]];
+		if ((h | l) & 0xF0) break;
+
+		uint8_t c = uint8_t((h << 4) | l);
+		out[i] = c;
+		sum += c;
 	}
+	return i;
+}
 
-	// run state machine
-	switch (u8state) {
-	case E_SERCMD_ASCII_CMD_EMPTY:
-		if (u8byte == ':') {
-			u8state = E_SERCMD_ASCII_CMD_READPAYLOAD;
-
-			u16pos = 0;
-			u16cksum = 0;
-			payload.redim(0);
-
-			// start new timer (if set timeout)
-			TimeOut::start();
-		}
-		break;
-
-	case E_SERCMD_ASCII_CMD_READPAYLOAD:
-		if ((u8byte >= '0' && u8byte <= '9') || (u8byte >= 'A' && u8byte <= 'F')) {
-			/* オーバーフローのチェック */
-			//if (payload.length_max() >= (u16pos / 2) - 1) {
-			//	u8state = E_SERCMD_ASCII_CMD_ERROR;
-			//	break;
-			//}
-
-			/* 文字の16進変換 */
-			const uint8_t u8tbl[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0, 0, 0, 0, 0, 10, 11, 12, 13, 14, 15 };
-			uint8_t u8val = u8tbl[u8byte - '0'];
-
-			/* バイナリ値として格納する */
-			// int i = u16pos / 2;
-			// unsigned char* p = &payload[u16pos / 2];
-
-			if (!(u16pos & 1)) {
-				if (!payload.append(u8val << 4)) {
-					u8state = E_SERCMD_ASCII_CMD_ERROR;
-				}
-			}
-			else {
-				uint8_t c = payload[-1]; // -1 は末尾
-				c |= u8val;
-
-				payload[-1] = c;
-				u16cksum += c;
-			}
-
-			u16pos++; // [0-9A-F]を１文字入れるごとにインクリメントする
-		}
-		else if (u8byte == 0x0d || u8byte == 0x0a) { // CR入力
-			if (u16pos >= 4 && ((u16pos & 1) == 0) // データ部１バイト、チェックサム１バイト以上
-				) {
-				// チェックサムの確認
-				u16cksum &= 0xFF; // チェックサムを 8bit に切り捨てる
-				if (u16cksum) { // 正しければ 0 になっているはず
-					// 格納値
-					uint8_t u8lrc = payload[-1]; // u16posは最後のデータの次の位置
-					// 計算値(二の補数の計算、ビット反転+1), デバッグ用に入力系列に対応する正しいLRCを格納しておく
-					u16cksum = (~(u16cksum - u8lrc) + 1) & 0xFF;
-					u8state = E_SERCMD_ASCII_CMD_CHECKSUM_ERROR;
-				}
-				else {
-					// LRCが正しければ、全部足したら 0 になる。
-					u8state = E_SERCMD_ASCII_CMD_COMPLETE; // 完了！
-					payload.redim(payload.length() - 1); // 末尾の１文字を削除
-				}
-			}
-			else {
-				u8state = E_SERCMD_ASCII_CMD_ERROR;
-			}
-		}
-		else if (u8byte == 'X') {
-			// X で終端したらチェックサムの計算を省く
-			if (u16pos >= 2 && ((u16pos & 1) == 0)) { // 入力データあり
-				u8state = E_SERCMD_ASCII_CMD_COMPLETE; // 完了！
-			}
-		}
-		else {
-			u8state = E_SERCMD_ASCII_CMD_EMPTY;
-		}
-		break;
-
-	default:
-		break;
+/// <summary>
+/// 16進文字列のバイト列への変換（16文字単位、端数はスカラー版）
+/// </summary>
+size_t TWESERCMD::hex_decode_ascii(const uint8_t* s, size_t n_max, uint8_t* out, uint8_t& sum) {
+	size_t i = 0;
+
+#if defined(TWESERCMD_ASCII_HEX_SSE2)
+	const __m128i c_dig_l = _mm_set1_epi8('0' - 1), c_dig_h = _mm_set1_epi8('9' + 1);
+	const __m128i c_alp_l = _mm_set1_epi8('A' - 1), c_alp_h = _mm_set1_epi8('F' + 1);
+	const __m128i c_zero = _mm_set1_epi8('0'), c_7 = _mm_set1_epi8(7);
+	const __m128i c_lo = _mm_set1_epi16(0x00FF);
+	__m128i acc = _mm_setzero_si128();
+
+	for (; i + 8 <= n_max; i += 8) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i));
+		__m128i dig = _mm_and_si128(_mm_cmpgt_epi8(v, c_dig_l), _mm_cmpgt_epi8(c_dig_h, v));
+		__m128i alp = _mm_and_si128(_mm_cmpgt_epi8(v, c_alp_l), _mm_cmpgt_epi8(c_alp_h, v));
+		if (_mm_movemask_epi8(_mm_or_si128(dig, alp)) != 0xFFFF) break; // 16進文字以外がある
+
+		// '0'-'9' -> 0-9, 'A'-'F' -> 10-15 ('A' - '0' - 7 = 10)
+		__m128i val = _mm_sub_epi8(_mm_sub_epi8(v, c_zero), _mm_and_si128(alp, c_7));
+		// 偶数位置が上位4bit、奇数位置が下位4bit (16bit単位で結合)
+		__m128i w = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(val, c_lo), 4), _mm_srli_epi16(val, 8));
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w, w));
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(w, _mm_setzero_si128()));
 	}
+	sum += uint8_t(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#elif defined(TWESERCMD_ASCII_HEX_NEON)
+	for (; i + 8 <= n_max; i += 8) {
+		uint8x16_t v = vld1q_u8(s + 2 * i);
+		uint8x16_t d = vsubq_u8(v, vdupq_n_u8('0'));
+		uint8x16_t a = vsubq_u8(v, vdupq_n_u8('A'));
+		uint8x16_t dig = vcleq_u8(d, vdupq_n_u8(9));
+		uint8x16_t alp = vcleq_u8(a, vdupq_n_u8(5));
+		if (vminvq_u8(vorrq_u8(dig, alp)) != 0xFF) break; // 16進文字以外がある
+
+		uint8x16_t val = vbslq_u8(dig, d, vaddq_u8(a, vdupq_n_u8(10)));
+		// 偶数位置が上位4bit、奇数位置が下位4bit
+		uint8x16x2_t uz = vuzpq_u8(val, val);
+		uint8x8_t c = vorr_u8(vshl_n_u8(vget_low_u8(uz.val[0]), 4), vget_low_u8(uz.val[1]));
+
+		vst1_u8(out + i, c);
+		sum += vaddv_u8(c);
+	}
+#endif
 
-	return u8state;
+	return i + s_hex_decode_scalar(s + 2 * i, n_max - i, out + i, sum);
 }
 
-
-
 /** @ingroup SERCMD
  * シリアルコマンドアスキー形式の出力補助関数。１バイトを１６進数２文字で出力する (0xA5 -> "A5")
  *
@@ -150,27 +127,72 @@ void AsciiParser::vPutByte(uint8_t u8byte, uint8_t* pu8lrc, IStreamOut& vPutChar
 }
 
 /// <summary>
-/// ASCII形式の出力(staticメソッド)
+/// ASCII形式の出力を連続バッファに書き出す (out は 2*len+5 バイト以上)
 /// </summary>
-/// <param name="payload"></param>
-/// <param name="vPutChar"></param>
-void AsciiParser::s_vOutput(SmplBuf_Byte& payload, IStreamOut& vPutChar) {
-	unsigned char u8lrc = 0;
+/// <param name="p">ペイロード</param>
+/// <param name="len">ペイロード長</param>
+/// <param name="out">出力先</param>
+/// <returns>出力バイト数</returns>
+static int s_nFormatAscii(const uint8_t* p, int len, uint8_t* out) {
+	static const uint8_t au8tbl[] = "0123456789ABCDEF";
+	uint8_t* q = out;
+	uint8_t u8lrc = 0;
 
 	// 先頭の :
-	vPutChar(':');
+	*q++ = ':';
 
-	uint8_t* p = payload.begin().raw_ptr();
-	while (p != payload.end().raw_ptr()) {
-		vPutByte(*p, &u8lrc, vPutChar);
-		p++;
+	for (int i = 0; i < len; i++) {
+		uint8_t c = p[i];
+		*q++ = au8tbl[c >> 4];
+		*q++ = au8tbl[c & 0x0F];
+		u8lrc += c;
 	}
 
 	// ２の補数の計算 (LRC)
 	u8lrc = ~u8lrc + 1;
-	vPutByte(u8lrc, NULL, vPutChar);
+	*q++ = au8tbl[u8lrc >> 4];
+	*q++ = au8tbl[u8lrc & 0x0F];
 
 	// Trailer byte
-	vPutChar(0x0D);
-	vPutChar(0x0A);
-}
\ No newline at end of file
+	*q++ = 0x0D;
+	*q++ = 0x0A;
+
+	return int(q - out);
+}
+
+/// <summary>
+/// ASCII形式の出力(staticメソッド)
+/// 連続バッファに整形してから一度に出力する。
+/// </summary>
+/// <param name="payload"></param>
+/// <param name="vPutChar"></param>
+void AsciiParser::s_vOutput(SmplBuf_Byte& payload, IStreamOut& vPutChar) {
+	const int len = int(payload.length());
+	const int len_out = len * 2 + 5;
+	uint8_t buf[256];
+
+	if (len_out <= int(sizeof(buf))) {
+		// short command (most cases), use stack.
+		vPutChar.write_bytes(buf, s_nFormatAscii(payload.begin().raw_ptr(), len, buf));
+	} else {
+		SmplBuf_Byte out;
+		s_vOutput(payload, out);
+		vPutChar.write_bytes(out.begin().raw_ptr(), int(out.length()));
+	}
+}
+
+/// <summary>
+/// ASCII形式の出力(staticメソッド)、連続バッファ out に格納する。
+/// </summary>
+/// <param name="payload"></param>
+/// <param name="out">出力先 (内容は置き換えられる)</param>
+void AsciiParser::s_vOutput(SmplBuf_Byte& payload, SmplBuf_Byte& out) {
+	const int len = int(payload.length());
+	const int len_out = len * 2 + 5;
+
+	if (out.resize_preserving_unused(len_out)) {
+		s_nFormatAscii(payload.begin().raw_ptr(), len, out.begin().raw_ptr());
+	} else {
+		out.clear(); // no space
+	}
+}
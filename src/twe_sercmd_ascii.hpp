@@ -7,43 +7,261 @@
 #include "twe_stream.hpp"
 #include "twe_sercmd.hpp"
 
-#if defined(TWE_STDINOUT_ONLY)
-# ifdef TWE_HAS_MILLIS
-extern uint32_t millis();
-# else
-#define millis() (0)
-# endif
-namespace TWESYS {
-	// Dummy TimeOut class
-	struct TimeOut {
-		void start() {}
-		void stop() {}
-		bool is_timeout() { return false; }
-		bool is_enabled() { return false; }
-	};
-}
-#else
-#include "twe_sys.hpp"
-#endif
+#include <cstring>
 
 namespace TWESERCMD {
+	typedef enum {
+		E_SERCMD_ASCII_CMD_EMPTY = 0,      //!< 入力されていない
+		E_SERCMD_ASCII_CMD_READCOLON,      //!< E_SERCMD_ASCII_CMD_READCOLON
+		E_SERCMD_ASCII_CMD_READPAYLOAD,    //!< E_SERCMD_ASCII_CMD_READPAYLOAD
+		E_SERCMD_ASCII_CMD_READCR,         //!< E_SERCMD_ASCII_CMD_READCR
+		E_SERCMD_ASCII_CMD_READLF,         //!< E_SERCMD_ASCII_CMD_READLF
+		E_SERCMD_ASCII_CMD_COMPLETE = 0x80,//!< 入力が完結した(LCRチェックを含め)
+		E_SERCMD_ASCII_CMD_ERROR = 0x81,          //!< 入力エラー
+		E_SERCMD_ASCII_CMD_CHECKSUM_ERROR = 0x82,       //!< LRCが間違っている
+	} teSercmdAsciiState;
+
 	/// <summary>
-	/// ASCII形式を解釈するクラス
+	/// 16進文字列のバイト列への変換（16文字単位は SSE2/NEON、端数はスカラー処理）
+	/// </summary>
+	/// <param name="s">16進文字列 (2*n_max 文字以上)</param>
+	/// <param name="n_max">変換する最大バイト数</param>
+	/// <param name="out">出力先</param>
+	/// <param name="sum">出力バイトの和 (LRC計算用, 加算する)</param>
+	/// <returns>変換したバイト数（16進文字以外があればその手前まで）</returns>
+	size_t hex_decode_ascii(const uint8_t* s, size_t n_max, uint8_t* out, uint8_t& sum);
+
+	class AsciiParser;
+
+	/// <summary>
+	/// ASCII形式の解釈部（状態遷移はインライン、D は派生クラス）
+	/// 派生クラスの型で直接呼び出すと仮想関数を経由しない。IParser& 経由では従来通り _u8Parse() を呼び出す。
 	/// </summary>
-	class AsciiParser : public IParser, public TWESYS::TimeOut
+	template <class D>
+	class AsciiParserBase : public IParser, public TWESYS::TimeOut
 	{
-	private:
+	protected:
 		uint16_t u16pos; //!< 入力位置（内部処理用）
 		uint16_t u16cksum; //!< チェックサム
 
 	protected:
-		inline void _vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p) { AsciiParser::s_vOutput(bobj, p); }
+		inline void _vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p);
+
+		/// <summary>
+		/// ASCII形式の１バイト解釈
+		/// </summary>
+		/// <param name="u8byte"></param>
+		/// <returns></returns>
+		inline uint8_t _parse_byte(uint8_t u8byte) {
+			// NOTE: timeout is checked per chunk by check_timeout().
+
+			// check for complete or error status
+			if (u8state >= 0x80) {
+				u8state = E_SERCMD_ASCII_CMD_EMPTY;
+			}
+
+			// run state machine
+			switch (u8state) {
+			case E_SERCMD_ASCII_CMD_EMPTY:
+				if (u8byte == ':') {
+					u8state = E_SERCMD_ASCII_CMD_READPAYLOAD;
+
+					u16pos = 0;
+					u16cksum = 0;
+					payload.redim(0);
+					_u32tick_frame = _u32tick_rx; // arrival tick of this frame
+
+					// start new timer (if set timeout), with the arrival tick if available.
+					if (_u32tick_rx) TimeOut::start_at(_u32tick_rx);
+					else TimeOut::start();
+				}
+				break;
+
+			case E_SERCMD_ASCII_CMD_READPAYLOAD:
+				if ((u8byte >= '0' && u8byte <= '9') || (u8byte >= 'A' && u8byte <= 'F')) {
+					/* 文字の16進変換 */
+					uint8_t u8val = (u8byte <= '9') ? uint8_t(u8byte - '0') : uint8_t(u8byte - 'A' + 10);
+
+					/* バイナリ値として格納する */
+					if (!(u16pos & 1)) {
+						if (!payload.append(u8val << 4)) {
+							u8state = E_SERCMD_ASCII_CMD_ERROR;
+						}
+					}
+					else {
+						uint8_t c = payload[-1]; // -1 は末尾
+						c |= u8val;
+
+						payload[-1] = c;
+						u16cksum += c;
+					}
+
+					u16pos++; // [0-9A-F]を１文字入れるごとにインクリメントする
+				}
+				else if (u8byte == 0x0d || u8byte == 0x0a) { // CR入力
+					if (u16pos >= 4 && ((u16pos & 1) == 0) // データ部１バイト、チェックサム１バイト以上
+						) {
+						// チェックサムの確認
+						u16cksum &= 0xFF; // チェックサムを 8bit に切り捨てる
+						if (u16cksum) { // 正しければ 0 になっているはず
+							// 格納値
+							uint8_t u8lrc = payload[-1]; // u16posは最後のデータの次の位置
+							// 計算値(二の補数の計算、ビット反転+1), デバッグ用に入力系列に対応する正しいLRCを格納しておく
+							u16cksum = (~(u16cksum - u8lrc) + 1) & 0xFF;
+							u8state = E_SERCMD_ASCII_CMD_CHECKSUM_ERROR;
+						}
+						else {
+							// LRCが正しければ、全部足したら 0 になる。
+							u8state = E_SERCMD_ASCII_CMD_COMPLETE; // 完了！
+							payload.redim(payload.length() - 1); // 末尾の１文字を削除
+						}
+					}
+					else {
+						u8state = E_SERCMD_ASCII_CMD_ERROR;
+					}
+				}
+				else if (u8byte == 'X') {
+					// X で終端したらチェックサムの計算を省く
+					if (u16pos >= 2 && ((u16pos & 1) == 0)) { // 入力データあり
+						u8state = E_SERCMD_ASCII_CMD_COMPLETE; // 完了！
+					}
+				}
+				else {
+					u8state = E_SERCMD_ASCII_CMD_EMPTY;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			return u8state;
+		}
+
+		uint8_t _u8Parse(uint8_t c) { return _parse_byte(c); }
+
+	private:
+		/// <summary>
+		/// チャンクのパース（系列が完結・エラーになるか、チャンク末尾まで処理する）
+		/// 系列外は ':' まで読み飛ばし、ペイロードは 16進文字が続く限りまとめて変換する。
+		/// それ以外のバイト(':' 終端 エラー 奇数文字目)は _parse_byte() で１バイトずつ処理する。
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>処理したバイト数（系列が完結・エラーになった場合はそのバイトまで）</returns>
+		size_t _parse_chunk(const uint8_t* p, size_t n) {
+			const uint8_t* s = p;
+			const uint8_t* e = p + n;
+
+			while (s < e) {
+				if (u8state >= 0x80) {
+					u8state = E_SERCMD_ASCII_CMD_EMPTY;
+				}
+
+				if (u8state == E_SERCMD_ASCII_CMD_EMPTY) {
+					// 系列の先頭まで読み飛ばす
+					auto q = static_cast<const uint8_t*>(memchr(s, ':', size_t(e - s)));
+					if (q == nullptr) return n;
+					s = q;
+				}
+				else {
+					// 16進文字が続く限りまとめて変換する
+					size_t l = parse_payload(s, size_t(e - s));
+					if (l > 0) {
+						s += l;
+						continue;
+					}
+				}
+
+				// ':' 終端 エラー等は１バイトずつ処理
+				if (_parse_byte(*s++) >= 0x80) break;
+			}
+
+			return size_t(s - p);
+		}
 
 	public:
-		AsciiParser(TWEUTILS::SmplBuf_Byte& bobj) : IParser(bobj), u16pos(0), u16cksum(0) { }
-		AsciiParser(size_t maxbuffsiz) : IParser(maxbuffsiz), u16pos(0), u16cksum(0) { }
-		~AsciiParser() {}
-		uint8_t _u8Parse(uint8_t c);
+		AsciiParserBase(TWEUTILS::SmplBuf_Byte& bobj) : IParser(bobj), u16pos(0), u16cksum(0) { }
+		AsciiParserBase(size_t maxbuffsiz) : IParser(maxbuffsiz), u16pos(0), u16cksum(0) { }
+
+		// putting a byte and do parse (not via virtual call)
+		inline D& operator << (char_t c) { return Parse(c); }
+		inline D& operator << (int c) { return Parse(c); }
+		inline D& Parse(uint8_t u8b) { _on_state(_parse_byte(u8b)); return static_cast<D&>(*this); }
+
+		/// <summary>
+		/// 受信途中の系列のタイムアウト確認 (IParser::check_timeout())
+		/// </summary>
+		bool check_timeout(uint32_t now) {
+			return _discard_on_timeout(*this, now);
+		}
+
+		/// <summary>
+		/// ペイロード受信中の 16進文字をまとめて変換する（バッファに入る分だけ）
+		/// 状態は１バイトずつ Parse() した場合と同じになる。
+		/// </summary>
+		/// <param name="s">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>処理したバイト数（ペイロード受信中でないか、先頭が16進文字でなければ 0）</returns>
+		size_t parse_payload(const uint8_t* s, size_t n) {
+			if (u8state != E_SERCMD_ASCII_CMD_READPAYLOAD || (u16pos & 1)) return 0;
+
+			size_t n_room = size_t(payload.capacity() - payload.length());
+			size_t n_pair = n / 2;
+			if (n_pair > n_room) n_pair = n_room;
+
+			uint8_t sum = 0;
+			size_t n_dec = hex_decode_ascii(s, n_pair, payload.data() + payload.length(), sum);
+			if (n_dec > 0) {
+				payload.resize_preserving_unused(payload.length() + TWEUTILS::SmplBuf_Byte::size_type(n_dec));
+				u16cksum += sum;
+				u16pos += uint16_t(n_dec * 2);
+			}
+			return n_dec * 2;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース
+		/// ':' の探索は memchr()、16進変換と LRC 計算は 16文字単位(SSE2/NEON)でまとめて行う。
+		/// 結果は１バイトずつ Parse() した場合と同じで、完結した系列ごとに fn(*this) を呼び出す。
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <param name="fn">完結時に呼び出す関数 (void fn(D&amp;))</param>
+		/// <returns>完結した系列数</returns>
+		template <typename FN>
+		size_t parse(const uint8_t* p, size_t n, FN&& fn) {
+			size_t n_frames = 0;
+
+			// timeout is checked once per chunk with its arrival tick.
+			if (n > 0) check_timeout(_u32tick_rx);
+
+			while (n > 0) {
+				size_t l = _parse_chunk(p, n);
+				p += l;
+				n -= l;
+
+				if (u8state >= 0x80) {
+					_on_state(u8state);
+					if (u8state == E_TWESERCMD_COMPLETE) {
+						n_frames++;
+						fn(static_cast<D&>(*this));
+					}
+				}
+			}
+
+			return n_frames;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース（完結した系列は set_frame_pool() の FramePool から取り出す）
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>完結した系列数</returns>
+		size_t parse(const uint8_t* p, size_t n) {
+			return parse(p, n, [](D&) {});
+		}
 
 		/// <summary>
 		/// 再初期化
@@ -53,6 +271,17 @@ namespace TWESERCMD {
 			u16cksum = 0;
 			u16pos = 0;
 		}
+	};
+
+	/// <summary>
+	/// ASCII形式を解釈するクラス
+	/// </summary>
+	class AsciiParser : public AsciiParserBase<AsciiParser>
+	{
+	public:
+		AsciiParser(TWEUTILS::SmplBuf_Byte& bobj) : AsciiParserBase(bobj) { }
+		AsciiParser(size_t maxbuffsiz) : AsciiParserBase(maxbuffsiz) { }
+		~AsciiParser() {}
 
 		/// <summary>
 		/// static 定義のフォーマット出力関数（１バイト分出力＆チェックサム計算）
@@ -67,5 +296,30 @@ namespace TWESERCMD {
 		/// <param name="bobj"></param>
 		/// <param name="p"></param>
 		static void s_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p);
+
+		/// <summary>
+		/// static 定義のフォーマット出力関数（連続バッファへ出力）
+		/// </summary>
+		/// <param name="bobj"></param>
+		/// <param name="out">出力先</param>
+		static void s_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWEUTILS::SmplBuf_Byte& out);
 	};
-}
\ No newline at end of file
+
+	/// <summary>
+	/// ASCII形式を解釈するクラス（バッファ N バイトをオブジェクト内に持つ）
+	/// ヒープを使わず、型が確定しているためパース処理はすべてインライン展開される。
+	/// </summary>
+	template <int N>
+	class AsciiParserT : private _ParserBufferL<N>, public AsciiParserBase<AsciiParserT<N>>
+	{
+	public:
+		AsciiParserT() : AsciiParserBase<AsciiParserT<N>>(this->_buf_payload.get()) { }
+		~AsciiParserT() {}
+
+		AsciiParserT(const AsciiParserT&) = delete;
+		AsciiParserT& operator = (const AsciiParserT&) = delete;
+	};
+
+	template <class D>
+	inline void AsciiParserBase<D>::_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p) { AsciiParser::s_vOutput(bobj, p); }
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include "twe_common.hpp"
+#include "twe_stream.hpp"
+#include "twe_sercmd.hpp"
+#include "twe_sercmd_ascii.hpp"
+#include "twe_sercmd_binary.hpp"
+
+namespace TWESERCMD {
+	/// <summary>
+	/// 系列の書式 (AutoParser::format())
+	/// </summary>
+	enum class E_FMT : uint8_t {
+		NONE = 0, //!< 不明（未受信）
+		ASCII,    //!< アスキー形式 (:...[CR][LF])
+		BINARY    //!< バイナリ形式 (0xA5 0x5A ...)
+	};
+
+	/// <summary>
+	/// アスキー形式とバイナリ形式が混在する入力を解釈するクラス
+	/// 系列の先頭 (':' または 0xA5) で書式を判定し、系列の終わりまでは同じ書式で解釈する。
+	/// ペイロードは書式によらず共通のバッファに格納され、完結した系列は IParser と同様に扱える。
+	/// </summary>
+	class AutoParser : public IParser, public TWESYS::TimeOut
+	{
+	private:
+		AsciiParser _ascii;   //!< アスキー形式の解釈部 (payload を共有)
+		BinaryParser _binary; //!< バイナリ形式の解釈部 (payload を共有)
+		E_FMT _mode;          //!< 解釈中の系列の書式
+		E_FMT _fmt;           //!< 最後に終了した系列の書式
+
+		// 系列の先頭バイトから書式を判定する
+		static inline E_FMT _detect(uint8_t c) {
+			return c == ':' ? E_FMT::ASCII : (c == 0xA5 ? E_FMT::BINARY : E_FMT::NONE);
+		}
+
+		// 解釈中の書式の解釈部に１バイト渡す
+		inline uint8_t _feed(uint8_t c) {
+			return (_mode == E_FMT::ASCII) ? _ascii.Parse(c).state() : _binary.Parse(c).state();
+		}
+
+		// 新しい系列を開始する
+		inline void _begin(E_FMT mode) {
+			_mode = mode;
+			_u32tick_frame = _u32tick_rx; // arrival tick of this frame
+			if (_mode == E_FMT::ASCII) _ascii.set_tick(_u32tick_rx);
+			else _binary.set_tick(_u32tick_rx);
+
+			// start new timer (if set timeout), with the arrival tick if available.
+			if (_u32tick_rx) TimeOut::start_at(_u32tick_rx);
+			else TimeOut::start();
+		}
+
+	protected:
+		void _vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p) {
+			if (_fmt == E_FMT::BINARY) BinaryParser::s_vOutput(bobj, p);
+			else AsciiParser::s_vOutput(bobj, p);
+		}
+
+		/// <summary>
+		/// １バイト解釈
+		/// </summary>
+		/// <param name="c"></param>
+		/// <returns>状態 (teSerCmdGenState, 0x80 未満の値は解釈中)</returns>
+		inline uint8_t _parse_byte(uint8_t c) {
+			if (u8state == E_TWESERCMD_EMPTY || u8state >= 0x80) {
+				E_FMT mode = _detect(c);
+				if (mode == E_FMT::NONE) {
+					u8state = E_TWESERCMD_EMPTY;
+					return u8state;
+				}
+				_begin(mode);
+			}
+
+			uint8_t s = _feed(c);
+
+			// the other format starts in the middle of a frame (e.g. the parent was switched).
+			if (s == E_TWESERCMD_EMPTY || s == E_TWESERCMD_ERROR) {
+				E_FMT mode = _detect(c);
+				if (mode != E_FMT::NONE && mode != _mode) {
+					if (s == E_TWESERCMD_ERROR) _on_state(s); // count the broken one.
+					_begin(mode);
+					s = _feed(c);
+				}
+			}
+
+			if (s >= 0x80) _fmt = _mode;
+			if (s == E_TWESERCMD_EMPTY || s >= 0x80) _mode = E_FMT::NONE;
+
+			u8state = s;
+			return u8state;
+		}
+
+		uint8_t _u8Parse(uint8_t c) { return _parse_byte(c); }
+
+	public:
+		AutoParser(TWEUTILS::SmplBuf_Byte& bobj) : IParser(bobj), _ascii(payload), _binary(payload), _mode(E_FMT::NONE), _fmt(E_FMT::NONE) { }
+		AutoParser(size_t maxbuffsiz) : IParser(maxbuffsiz), _ascii(payload), _binary(payload), _mode(E_FMT::NONE), _fmt(E_FMT::NONE) { }
+		~AutoParser() {}
+
+		AutoParser(const AutoParser&) = delete;
+		AutoParser& operator = (const AutoParser&) = delete;
+
+		// putting a byte and do parse (not via virtual call)
+		inline AutoParser& operator << (char_t c) { return Parse(c); }
+		inline AutoParser& operator << (int c) { return Parse(c); }
+		inline AutoParser& Parse(uint8_t u8b) { _on_state(_parse_byte(u8b)); return *this; }
+
+		// the format of the last completed (or errored) frame.
+		inline E_FMT format() const { return _fmt; }
+
+		/// <summary>
+		/// 受信途中の系列のタイムアウト確認 (IParser::check_timeout())
+		/// </summary>
+		bool check_timeout(uint32_t now) {
+			if (_discard_on_timeout(*this, now)) {
+				// discard the partial frame of the sub parser as well.
+				if (_mode == E_FMT::ASCII) _ascii.reinit();
+				else _binary.reinit();
+				_mode = E_FMT::NONE;
+				return true;
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース
+		/// 系列外は ':' か 0xA5 まで読み飛ばし、ペイロードはまとめて変換・格納する。
+		/// 結果は１バイトずつ Parse() した場合と同じで、完結した系列ごとに fn(*this) を呼び出す。
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <param name="fn">完結時に呼び出す関数 (void fn(AutoParser&amp;))</param>
+		/// <returns>完結した系列数</returns>
+		template <typename FN>
+		size_t parse(const uint8_t* p, size_t n, FN&& fn) {
+			const uint8_t* e = p + n;
+			size_t n_frames = 0;
+
+			// timeout is checked once per chunk with its arrival tick.
+			if (n > 0) check_timeout(_u32tick_rx);
+
+			while (p < e) {
+				if (u8state == E_TWESERCMD_EMPTY || u8state >= 0x80) {
+					// skip to the head of a frame.
+					const uint8_t* q = p;
+					while (q < e && *q != ':' && *q != 0xA5) ++q;
+					if (q != p) {
+						u8state = E_TWESERCMD_EMPTY;
+						p = q;
+						continue;
+					}
+				}
+				else {
+					size_t l = (_mode == E_FMT::ASCII)
+						? _ascii.parse_payload(p, size_t(e - p))
+						: _binary.parse_payload(p, size_t(e - p));
+					if (l > 0) {
+						p += l;
+						continue;
+					}
+				}
+
+				uint8_t s = _parse_byte(*p++);
+				if (s >= 0x80) {
+					_on_state(s);
+					if (s == E_TWESERCMD_COMPLETE) {
+						n_frames++;
+						fn(*this);
+					}
+				}
+			}
+
+			return n_frames;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース（完結した系列は set_frame_pool() の FramePool から取り出す）
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>完結した系列数</returns>
+		size_t parse(const uint8_t* p, size_t n) {
+			return parse(p, n, [](AutoParser&) {});
+		}
+
+		/// <summary>
+		/// 再初期化
+		/// </summary>
+		void reinit() {
+			IParser::_init();
+			_ascii.reinit();
+			_binary.reinit();
+			_mode = E_FMT::NONE;
+			_fmt = E_FMT::NONE;
+		}
+	};
+
+	/// <summary>
+	/// アスキー形式とバイナリ形式が混在する入力を解釈するクラス（バッファ N バイトをオブジェクト内に持つ）
+	/// </summary>
+	template <int N>
+	class AutoParserT : private _ParserBufferL<N>, public AutoParser
+	{
+	public:
+		AutoParserT() : AutoParser(this->_buf_payload.get()) { }
+		~AutoParserT() {}
+	};
+}
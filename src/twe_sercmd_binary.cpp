@@ -6,138 +6,118 @@
 #include "twe_sercmd.hpp"
 #include "twe_sercmd_binary.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define TWESERCMD_BINARY_XOR_SSE2
+# include <emmintrin.h>
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+# define TWESERCMD_BINARY_XOR_NEON
+# include <arm_neon.h>
+#endif
+
 using namespace TWE;
 using namespace TWESERCMD;
 using namespace TWESYS;
 using namespace TWEUTILS;
 
-namespace TWESERCMD {
-	typedef enum {
-		E_SERCMD_BINARY_EMPTY = 0,      //!< E_SERCMD_BINARY_EMPTY
-		E_SERCMD_BINARY_READSYNC,       //!< E_SERCMD_BINARY_READSYNC
-		E_SERCMD_BINARY_READLEN,        //!< E_SERCMD_BINARY_READLEN
-		E_SERCMD_BINARY_READLEN2,       //!< E_SERCMD_BINARY_READLEN2
-		E_SERCMD_BINARY_READPAYLOAD,    //!< E_SERCMD_BINARY_READPAYLOAD
-		E_SERCMD_BINARY_READCRC,        //!< E_SERCMD_BINARY_READCRC
-		E_SERCMD_BINARY_PLUS1,          //!< E_SERCMD_BINARY_PLUS1
-		E_SERCMD_BINARY_PLUS2,          //!< E_SERCMD_BINARY_PLUS2
-		E_SERCMD_BINARY_COMPLETE = 0x80,//!< E_SERCMD_BINARY_COMPLETE
-		E_SERCMD_BINARY_ERROR = 0x81,   //!< E_SERCMD_BINARY_ERROR
-		E_SERCMD_BINARY_CRCERROR = 0x82 //!< E_SERCMD_BINARY_CRCERROR
-	} teSerCmd_Binary;
-}
-
-/// <summary>
-/// バイナリ形式の１バイト解釈
-/// </summary>
-/// <param name="u8byte"></param>
-/// <returns></returns>
-uint8_t BinaryParser::_u8Parse(uint8_t u8byte) {
-	// check for timeout
-	if (TimeOut::is_enabled() && TimeOut::is_timeout()) {
-		u8state = E_SERCMD_BINARY_EMPTY;
-	}
-
-	// check for complete or error status
-	if (u8state >= 0x80) {
-		u8state = E_SERCMD_BINARY_EMPTY;
-	}
-
-	// run state machine
-	switch (u8state) {
-	case E_SERCMD_BINARY_EMPTY:
-		if (u8byte == SERCMD_SYNC_1) {
-			u8state = E_SERCMD_BINARY_READSYNC;
-			TimeOut::start(); // start timer again
-		}
-		break;
-
-	case E_SERCMD_BINARY_READSYNC:
-		if (u8byte == SERCMD_SYNC_2) {
-			u8state = E_SERCMD_BINARY_READLEN;
-		}
-		else {
-			u8state = E_SERCMD_BINARY_ERROR;
-		}
-		break;
-
-	case E_SERCMD_BINARY_READLEN:
-		if (u8byte & 0x80) {
-			// long length mode (1...
-			u8byte &= 0x7F;
-			u16pos = u8byte;
-			u8state = E_SERCMD_BINARY_READLEN2;
-
-		}
-		else {
-			// short length mode (1...127bytes)
-			if (u8byte && payload.redim(u8byte)) {
-				u8state = E_SERCMD_BINARY_READPAYLOAD;
-				u16pos = 0;
-				u16cksum = 0;
-			}
-			else {
-				u8state = E_SERCMD_BINARY_ERROR;
-			}
-		}
-		break;
-
-	case E_SERCMD_BINARY_READLEN2:
-		if (payload.redim(u16pos * 256 + u8byte)) {
-			u16pos = 0;
-			u16cksum = 0;
-			u8state = E_SERCMD_BINARY_READPAYLOAD;
-		}
-		else {
-			u8state = E_SERCMD_BINARY_ERROR;
+/** @ingroup SERCMD
+ * バイト列の XOR を計算する (16バイト単位でまとめて計算し、端数は１バイトずつ)
+ * @param p バイト列
+ * @param n 長さ
+ * @return 全バイトの XOR 値
+ */
+uint8_t TWESERCMD::xor_checksum(const uint8_t* p, size_t n) {
+	size_t i = 0;
+	uint8_t x = 0;
+
+#if defined(TWESERCMD_BINARY_XOR_SSE2)
+	if (n >= 16) {
+		__m128i acc = _mm_setzero_si128();
+		for (; i + 16 <= n; i += 16) {
+			acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
 		}
-		break;
-
-	case E_SERCMD_BINARY_READPAYLOAD:
-		payload[u16pos] = u8byte;
-		u16cksum ^= u8byte; // update XOR checksum
-		if (u16pos == payload.length() - 1) {
-			u8state = E_SERCMD_BINARY_READCRC;
+		// fold 16 bytes into 1 byte
+		acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+		acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+		acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+		acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+		x = uint8_t(_mm_cvtsi128_si32(acc));
+	}
+#elif defined(TWESERCMD_BINARY_XOR_NEON)
+	if (n >= 16) {
+		uint8x16_t acc = vdupq_n_u8(0);
+		for (; i + 16 <= n; i += 16) {
+			acc = veorq_u8(acc, vld1q_u8(p + i));
 		}
-		u16pos++;
-		break;
+		// fold 16 bytes into 1 byte
+		uint64_t v = vget_lane_u64(vreinterpret_u64_u8(veor_u8(vget_low_u8(acc), vget_high_u8(acc))), 0);
+		v ^= v >> 32;
+		v ^= v >> 16;
+		v ^= v >> 8;
+		x = uint8_t(v);
+	}
+#endif
 
-	case E_SERCMD_BINARY_READCRC:
-		u16cksum &= 0xFF;
-		if (u8byte == u16cksum) {
-			u8state = E_SERCMD_BINARY_COMPLETE;
-		}
-		else {
-			u8state = E_SERCMD_BINARY_CRCERROR;
-		}
-		break;
+	for (; i < n; i++) x ^= p[i];
+	return x;
+}
 
-	default:
-		break;
+/** @ingroup SERCMD
+ * バイナリ形式の出力を連続バッファに書き出す (out は len+6 バイト以上)
+ * @param p ペイロード
+ * @param len ペイロード長
+ * @param out 出力先
+ * @return 出力バイト数
+ */
+static int s_nFormatBinary(const uint8_t* p, int len, uint8_t* out) {
+	uint8_t* q = out;
+	uint8_t u8xor = 0;
+
+	*q++ = 0xA5; // SERCMD_SYNC_1
+	*q++ = 0x5A; // SERCMD_SYNC_2
+	*q++ = (uint8_t)(0x80 | (len >> 8));
+	*q++ = (uint8_t)(len & 0xff);
+
+	for (int i = 0; i < len; i++) {
+		u8xor ^= p[i];
+		*q++ = p[i];
 	}
 
-	return u8state;
+	*q++ = u8xor; // XOR check sum
+	*q++ = 0x4; // EOT
+
+	return int(q - out);
 }
 
 /** @ingroup SERCMD
  * バイナリ形式の出力 (staticメソッド)
+ * 連続バッファに整形してから一度に出力する。
  * @param pc
  * @param ps
  */
 void BinaryParser::s_vOutput(SmplBuf_Byte& payload, IStreamOut& vPutChar) {
-	unsigned char u8xor = 0;
+	const int len = int(payload.length());
+	uint8_t buf[256];
+
+	if (len + 6 <= int(sizeof(buf))) {
+		vPutChar.write_bytes(buf, s_nFormatBinary(payload.begin().raw_ptr(), len, buf));
+	} else {
+		SmplBuf_Byte out;
+		s_vOutput(payload, out);
+		vPutChar.write_bytes(out.begin().raw_ptr(), int(out.length()));
+	}
+}
 
-	vPutChar(SERCMD_SYNC_1);
-	vPutChar(SERCMD_SYNC_2);
-	vPutChar((unsigned char)(0x80 | (payload.length() >> 8)));
-	vPutChar(payload.length() & 0xff);
+/** @ingroup SERCMD
+ * バイナリ形式の出力 (staticメソッド)、連続バッファ out に格納する。
+ * @param payload
+ * @param out 出力先 (内容は置き換えられる)
+ */
+void BinaryParser::s_vOutput(SmplBuf_Byte& payload, SmplBuf_Byte& out) {
+	const int len = int(payload.length());
 
-	for (unsigned i = 0; i < payload.length(); i++) {
-		u8xor ^= payload[i];
-		vPutChar(payload[i]);
+	if (out.resize_preserving_unused(len + 6)) {
+		s_nFormatBinary(payload.begin().raw_ptr(), len, out.begin().raw_ptr());
+	} else {
+		out.clear(); // no space
 	}
-
-	vPutChar(u8xor); // XOR check sum
-	vPutChar(0x4); // EOT
 }
-
@@ -5,17 +5,43 @@
 
 #include "twe_common.hpp"
 #include "twe_stream.hpp"
-#include "twe_sys.hpp"
 #include "twe_sercmd.hpp"
 
+#include <cstring>
 
 namespace TWESERCMD {
+	typedef enum {
+		E_SERCMD_BINARY_EMPTY = 0,      //!< E_SERCMD_BINARY_EMPTY
+		E_SERCMD_BINARY_READSYNC,       //!< E_SERCMD_BINARY_READSYNC
+		E_SERCMD_BINARY_READLEN,        //!< E_SERCMD_BINARY_READLEN
+		E_SERCMD_BINARY_READLEN2,       //!< E_SERCMD_BINARY_READLEN2
+		E_SERCMD_BINARY_READPAYLOAD,    //!< E_SERCMD_BINARY_READPAYLOAD
+		E_SERCMD_BINARY_READCRC,        //!< E_SERCMD_BINARY_READCRC
+		E_SERCMD_BINARY_PLUS1,          //!< E_SERCMD_BINARY_PLUS1
+		E_SERCMD_BINARY_PLUS2,          //!< E_SERCMD_BINARY_PLUS2
+		E_SERCMD_BINARY_COMPLETE = 0x80,//!< E_SERCMD_BINARY_COMPLETE
+		E_SERCMD_BINARY_ERROR = 0x81,   //!< E_SERCMD_BINARY_ERROR
+		E_SERCMD_BINARY_CRCERROR = 0x82 //!< E_SERCMD_BINARY_CRCERROR
+	} teSerCmd_Binary;
+
 	/// <summary>
-	/// バイナリ形式を解釈するクラス
+	/// バイト列の XOR (バイナリ形式のチェックサム, 16バイト単位は SSE2/NEON)
 	/// </summary>
-	class BinaryParser : public IParser, public TWESYS::TimeOut
+	/// <param name="p">バイト列</param>
+	/// <param name="n">長さ</param>
+	/// <returns>全バイトの XOR 値</returns>
+	uint8_t xor_checksum(const uint8_t* p, size_t n);
+
+	class BinaryParser;
+
+	/// <summary>
+	/// バイナリ形式の解釈部（状態遷移はインライン、D は派生クラス）
+	/// 派生クラスの型で直接呼び出すと仮想関数を経由しない。IParser& 経由では従来通り _u8Parse() を呼び出す。
+	/// </summary>
+	template <class D>
+	class BinaryParserBase : public IParser, public TWESYS::TimeOut
 	{
-	private:
+	protected:
 		uint16_t u16pos; //!< 入力位置（内部処理用）
 		uint16_t  u16cksum; //!< チェックサム
 		
@@ -23,13 +49,201 @@ namespace TWESERCMD {
 		static const uint8_t SERCMD_SYNC_1 = 0xA5;
 		static const uint8_t SERCMD_SYNC_2 = 0x5A;
 
-		inline void _vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p) { BinaryParser::s_vOutput(bobj, p); }
-		uint8_t _u8Parse(uint8_t u8byte);
+		inline void _vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p);
+
+		/// <summary>
+		/// バイナリ形式の１バイト解釈
+		/// </summary>
+		/// <param name="u8byte"></param>
+		/// <returns></returns>
+		inline uint8_t _parse_byte(uint8_t u8byte) {
+			// NOTE: timeout is checked per chunk by check_timeout().
+
+			// check for complete or error status
+			if (u8state >= 0x80) {
+				u8state = E_SERCMD_BINARY_EMPTY;
+			}
+
+			// run state machine
+			switch (u8state) {
+			case E_SERCMD_BINARY_EMPTY:
+				if (u8byte == SERCMD_SYNC_1) {
+					u8state = E_SERCMD_BINARY_READSYNC;
+					_u32tick_frame = _u32tick_rx; // arrival tick of this frame
+					// start timer again, with the arrival tick if available.
+					if (_u32tick_rx) TimeOut::start_at(_u32tick_rx);
+					else TimeOut::start();
+				}
+				break;
+
+			case E_SERCMD_BINARY_READSYNC:
+				if (u8byte == SERCMD_SYNC_2) {
+					u8state = E_SERCMD_BINARY_READLEN;
+				}
+				else {
+					u8state = E_SERCMD_BINARY_ERROR;
+				}
+				break;
+
+			case E_SERCMD_BINARY_READLEN:
+				if (u8byte & 0x80) {
+					// long length mode (1...
+					u8byte &= 0x7F;
+					u16pos = u8byte;
+					u8state = E_SERCMD_BINARY_READLEN2;
+
+				}
+				else {
+					// short length mode (1...127bytes)
+					if (u8byte && payload.redim(u8byte)) {
+						u8state = E_SERCMD_BINARY_READPAYLOAD;
+						u16pos = 0;
+						u16cksum = 0;
+					}
+					else {
+						u8state = E_SERCMD_BINARY_ERROR;
+					}
+				}
+				break;
+
+			case E_SERCMD_BINARY_READLEN2:
+				if (payload.redim(u16pos * 256 + u8byte)) {
+					u16pos = 0;
+					u16cksum = 0;
+					u8state = E_SERCMD_BINARY_READPAYLOAD;
+				}
+				else {
+					u8state = E_SERCMD_BINARY_ERROR;
+				}
+				break;
+
+			case E_SERCMD_BINARY_READPAYLOAD:
+				payload[u16pos] = u8byte;
+				u16cksum ^= u8byte; // update XOR checksum
+				if (u16pos == payload.length() - 1) {
+					u8state = E_SERCMD_BINARY_READCRC;
+				}
+				u16pos++;
+				break;
+
+			case E_SERCMD_BINARY_READCRC:
+				u16cksum &= 0xFF;
+				if (u8byte == u16cksum) {
+					u8state = E_SERCMD_BINARY_COMPLETE;
+				}
+				else {
+					u8state = E_SERCMD_BINARY_CRCERROR;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			return u8state;
+		}
+
+		uint8_t _u8Parse(uint8_t u8byte) { return _parse_byte(u8byte); }
 
 	public:
-		BinaryParser(TWEUTILS::SmplBuf_Byte& bobj) : IParser(bobj), u16pos(0), u16cksum(0) {  }
-		~BinaryParser() {}
+		BinaryParserBase(TWEUTILS::SmplBuf_Byte& bobj) : IParser(bobj), u16pos(0), u16cksum(0) {  }
+
+		// putting a byte and do parse (not via virtual call)
+		inline D& operator << (char_t c) { return Parse(c); }
+		inline D& operator << (int c) { return Parse(c); }
+		inline D& Parse(uint8_t u8b) { _on_state(_parse_byte(u8b)); return static_cast<D&>(*this); }
+
+		/// <summary>
+		/// 受信途中の系列のタイムアウト確認 (IParser::check_timeout())
+		/// </summary>
+		bool check_timeout(uint32_t now) {
+			return _discard_on_timeout(*this, now);
+		}
 		
+		/// <summary>
+		/// ペイロード受信中のバイト列をまとめて格納する
+		/// 長さは確定しているので、チャンク内にある分を memcpy() でコピーし XOR を計算する。
+		/// 状態は１バイトずつ Parse() した場合と同じになる。
+		/// </summary>
+		/// <param name="s">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>処理したバイト数（ペイロード受信中でなければ 0）</returns>
+		size_t parse_payload(const uint8_t* s, size_t n) {
+			if (u8state != E_SERCMD_BINARY_READPAYLOAD || u16pos >= payload.length()) return 0;
+
+			size_t l = size_t(payload.length() - u16pos);
+			if (l > n) l = n;
+
+			uint8_t* q = payload.data() + u16pos;
+			memcpy(q, s, l);
+			u16cksum ^= xor_checksum(q, l); // update XOR checksum
+			u16pos += uint16_t(l);
+
+			if (u16pos == payload.length()) {
+				u8state = E_SERCMD_BINARY_READCRC;
+			}
+			return l;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース
+		/// 系列外は memchr() で 0xA5 まで読み飛ばし、ペイロードは parse_payload() でまとめて格納する。
+		/// 結果は１バイトずつ Parse() した場合と同じで、完結した系列ごとに fn(*this) を呼び出す。
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <param name="fn">完結時に呼び出す関数 (void fn(D&amp;))</param>
+		/// <returns>完結した系列数</returns>
+		template <typename FN>
+		size_t parse(const uint8_t* p, size_t n, FN&& fn) {
+			const uint8_t* e = p + n;
+			size_t n_frames = 0;
+
+			// timeout is checked once per chunk with its arrival tick.
+			if (n > 0) check_timeout(_u32tick_rx);
+
+			while (p < e) {
+				if (u8state == E_SERCMD_BINARY_EMPTY || u8state >= 0x80) {
+					// skip to the head of a frame.
+					auto q = static_cast<const uint8_t*>(memchr(p, SERCMD_SYNC_1, size_t(e - p)));
+					if (q == nullptr) q = e;
+					if (q != p) {
+						u8state = E_SERCMD_BINARY_EMPTY;
+						p = q;
+						continue;
+					}
+				}
+				else {
+					size_t l = parse_payload(p, size_t(e - p));
+					if (l > 0) {
+						p += l;
+						continue;
+					}
+				}
+
+				uint8_t s = _parse_byte(*p++);
+				if (s >= 0x80) {
+					_on_state(s);
+					if (s == E_TWESERCMD_COMPLETE) {
+						n_frames++;
+						fn(static_cast<D&>(*this));
+					}
+				}
+			}
+
+			return n_frames;
+		}
+
+		/// <summary>
+		/// チャンク単位のパース（完結した系列は set_frame_pool() の FramePool から取り出す）
+		/// </summary>
+		/// <param name="p">入力バイト列</param>
+		/// <param name="n">長さ</param>
+		/// <returns>完結した系列数</returns>
+		size_t parse(const uint8_t* p, size_t n) {
+			return parse(p, n, [](D&) {});
+		}
+
 		/// <summary>
 		/// 再初期化
 		/// </summary>
@@ -38,6 +252,16 @@ namespace TWESERCMD {
 			u16cksum = 0;
 			u16pos = 0;
 		}
+	};
+
+	/// <summary>
+	/// バイナリ形式を解釈するクラス
+	/// </summary>
+	class BinaryParser : public BinaryParserBase<BinaryParser>
+	{
+	public:
+		BinaryParser(TWEUTILS::SmplBuf_Byte& bobj) : BinaryParserBase(bobj) {  }
+		~BinaryParser() {}
 
 		/// <summary>
 		/// static 定義のフォーマット出力関数
@@ -45,6 +269,30 @@ namespace TWESERCMD {
 		/// <param name="bobj"></param>
 		/// <param name="p"></param>
 		static void s_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p);
+
+		/// <summary>
+		/// static 定義のフォーマット出力関数（連続バッファへ出力）
+		/// </summary>
+		/// <param name="bobj"></param>
+		/// <param name="out">出力先</param>
+		static void s_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWEUTILS::SmplBuf_Byte& out);
+	};
+
+	/// <summary>
+	/// バイナリ形式を解釈するクラス（バッファ N バイトをオブジェクト内に持つ）
+	/// ヒープを使わず、型が確定しているためパース処理はすべてインライン展開される。
+	/// </summary>
+	template <int N>
+	class BinaryParserT : private _ParserBufferL<N>, public BinaryParserBase<BinaryParserT<N>>
+	{
+	public:
+		BinaryParserT() : BinaryParserBase<BinaryParserT<N>>(this->_buf_payload.get()) { }
+		~BinaryParserT() {}
+
+		BinaryParserT(const BinaryParserT&) = delete;
+		BinaryParserT& operator = (const BinaryParserT&) = delete;
 	};
 
+	template <class D>
+	inline void BinaryParserBase<D>::_vOutput(TWEUTILS::SmplBuf_Byte& bobj, TWE::IStreamOut& p) { BinaryParser::s_vOutput(bobj, p); }
 }
@@ -0,0 +1,286 @@
+#pragma once
+
+/* Copyright (C) 2019-2022 Mono Wireless Inc. All Rights Reserved.
+ * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
+
+#include "twe_common.hpp"
+#include "twe_utils_fixedque.hpp"
+
+#include <atomic>
+#include <memory>
+#include <cstring>
+
+namespace TWESERCMD {
+	class FramePool;
+
+	/**
+	 * @class	FrameRef
+	 *
+	 * @brief	A reference to a completed frame stored in FramePool.
+	 * 			Copying adds a reference, the slot returns to the pool when the last
+	 * 			reference is released. It can be passed to another thread, but must
+	 * 			not outlive the pool.
+	 */
+	class FrameRef {
+		friend class FramePool;
+
+		FramePool* _pool;
+		uint16_t _idx;
+
+		// adopts a reference already counted.
+		FrameRef(FramePool* pool, uint16_t idx) : _pool(pool), _idx(idx) {}
+
+	public:
+		FrameRef() : _pool(nullptr), _idx(0) {}
+		FrameRef(const FrameRef& ref);
+		FrameRef(FrameRef&& ref) noexcept : _pool(ref._pool), _idx(ref._idx) { ref._pool = nullptr; }
+		~FrameRef() { reset(); }
+
+		FrameRef& operator = (const FrameRef& ref) {
+			if (this != &ref) {
+				FrameRef tmp(ref);
+				*this = std::move(tmp);
+			}
+			return *this;
+		}
+
+		FrameRef& operator = (FrameRef&& ref) noexcept {
+			if (this != &ref) {
+				reset();
+				_pool = ref._pool;
+				_idx = ref._idx;
+				ref._pool = nullptr;
+			}
+			return *this;
+		}
+
+		// true if it refers a frame.
+		inline explicit operator bool() const { return _pool != nullptr; }
+
+		// release the reference.
+		inline void reset();
+
+		// payload of the frame
+		inline uint8_t* data() const;
+		// length of the payload
+		inline uint16_t length() const;
+		// arrival tick of the frame (0: unknown)
+		inline uint32_t tick() const;
+	};
+
+	/**
+	 * @class	FramePool
+	 *
+	 * @brief	Bounded pool of completed frames (see IParser::set_frame_pool()).
+	 * 			Payloads are copied into fixed size slots of one arena, the slots are
+	 * 			reference counted by FrameRef. Completed frames are queued in order,
+	 * 			the consumer pops them as FrameRef and can hold or batch them,
+	 * 			then the byte loop never waits on the processing of them.
+	 *
+	 * 			Thread model: push() from one thread (the parser side),
+	 * 			pop() from one thread, FrameRef can be released by any thread.
+	 */
+	class FramePool {
+		friend class FrameRef;
+
+	public:
+		/**
+		 * @struct	stats
+		 *
+		 * @brief	counters of the pool (see get_stats()).
+		 */
+		struct stats {
+			uint32_t u32frames;    // frames stored
+			uint32_t u32exhausted; // frames dropped, as no slot is free
+			uint32_t u32too_long;  // frames dropped, as longer than the slot
+			uint16_t u16slots;     // number of slots
+			uint16_t u16slot_size; // bytes of a slot
+		};
+
+	private:
+		struct _slot {
+			std::atomic<uint16_t> ref; // 0: free
+			uint16_t len;
+			uint32_t tick;
+		};
+
+		std::unique_ptr<uint8_t[]> _arena;
+		std::unique_ptr<_slot[]> _slots;
+		uint16_t _n_slots;
+		uint16_t _slot_size;
+		uint16_t _cursor; // next slot to look for (producer side)
+
+		TWEUTILS::SpscQueue<uint16_t> _que; // completed frames, each entry holds one reference.
+
+		std::atomic<uint32_t> _u32frames;
+		std::atomic<uint32_t> _u32exhausted;
+		std::atomic<uint32_t> _u32too_long;
+
+		inline void _add_ref(uint16_t i) {
+			_slots[i].ref.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		inline void _release(uint16_t i) {
+			_slots[i].ref.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		// finds a free slot (producer side), returns n_slots if none.
+		uint16_t _alloc() {
+			for (uint16_t n = 0; n < _n_slots; n++) {
+				uint16_t i = _cursor;
+				if (++_cursor >= _n_slots) _cursor = 0;
+
+				// only the producer makes 0 -> 1, so no CAS is needed.
+				if (_slots[i].ref.load(std::memory_order_acquire) == 0) {
+					_slots[i].ref.store(1, std::memory_order_relaxed);
+					return i;
+				}
+			}
+			return _n_slots;
+		}
+
+	public:
+		/**
+		 * @fn	FramePool::FramePool(uint16_t n_slots, uint16_t slot_size)
+		 *
+		 * @brief	Constructor
+		 *
+		 * @param	n_slots  	number of frames which can be held at the same time.
+		 * @param	slot_size	max payload length of a frame.
+		 */
+		FramePool(uint16_t n_slots, uint16_t slot_size)
+			: _arena(new uint8_t[size_t(n_slots) * slot_size])
+			, _slots(new _slot[n_slots])
+			, _n_slots(n_slots), _slot_size(slot_size), _cursor(0)
+			, _que(n_slots)
+			, _u32frames(0), _u32exhausted(0), _u32too_long(0)
+		{
+			for (uint16_t i = 0; i < n_slots; i++) {
+				_slots[i].ref.store(0, std::memory_order_relaxed);
+				_slots[i].len = 0;
+				_slots[i].tick = 0;
+			}
+		}
+
+		FramePool(const FramePool&) = delete;
+
+		/**
+		 * @fn	bool FramePool::push(const uint8_t* p, uint32_t len, uint32_t tick)
+		 *
+		 * @brief	Stores a completed frame and queues it. (producer side)
+		 *
+		 * @param	p   	payload.
+		 * @param	len 	length of payload.
+		 * @param	tick	arrival tick of the frame (0: unknown).
+		 *
+		 * @returns	True if it succeeds, false if dropped (no free slot or too long).
+		 */
+		bool push(const uint8_t* p, uint32_t len, uint32_t tick) {
+			if (len > _slot_size) {
+				_u32too_long.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			uint16_t i = _alloc();
+			if (i >= _n_slots) {
+				_u32exhausted.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			memcpy(&_arena[size_t(i) * _slot_size], p, len);
+			_slots[i].len = uint16_t(len);
+			_slots[i].tick = tick;
+
+			// the queue never gets full, as a slot is queued once at most.
+			_que.push(i);
+			_u32frames.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/**
+		 * @fn	bool FramePool::available()
+		 *
+		 * @brief	true if any completed frame is queued. (consumer side)
+		 */
+		inline bool available() const {
+			return !_que.empty();
+		}
+
+		/**
+		 * @fn	FrameRef FramePool::pop()
+		 *
+		 * @brief	Pops the oldest frame. (consumer side)
+		 *
+		 * @returns	the frame, empty reference if nothing is queued.
+		 */
+		FrameRef pop() {
+			uint16_t i;
+			if (_que.pop_front(&i, 1) == 0) return FrameRef();
+			return FrameRef(this, i); // takes over the reference of the queue.
+		}
+
+		/**
+		 * @fn	size_t FramePool::pop(FrameRef* p, size_t n)
+		 *
+		 * @brief	Pops frames at once (for batch processing). (consumer side)
+		 *
+		 * @param	p	array to store references.
+		 * @param	n	size of the array.
+		 *
+		 * @returns	number of frames popped.
+		 */
+		size_t pop(FrameRef* p, size_t n) {
+			size_t ct = 0;
+			uint16_t buf[32];
+
+			while (ct < n) {
+				uint32_t l = uint32_t(n - ct);
+				if (l > 32) l = 32;
+				l = _que.pop_front(buf, l);
+				if (l == 0) break;
+
+				for (uint32_t j = 0; j < l; j++) p[ct++] = FrameRef(this, buf[j]);
+			}
+
+			return ct;
+		}
+
+		/**
+		 * @fn	stats FramePool::get_stats()
+		 *
+		 * @brief	Gets the counters.
+		 */
+		stats get_stats() const {
+			stats s;
+			s.u32frames = _u32frames.load(std::memory_order_relaxed);
+			s.u32exhausted = _u32exhausted.load(std::memory_order_relaxed);
+			s.u32too_long = _u32too_long.load(std::memory_order_relaxed);
+			s.u16slots = _n_slots;
+			s.u16slot_size = _slot_size;
+			return s;
+		}
+	};
+
+	inline FrameRef::FrameRef(const FrameRef& ref) : _pool(ref._pool), _idx(ref._idx) {
+		if (_pool) _pool->_add_ref(_idx);
+	}
+
+	inline void FrameRef::reset() {
+		if (_pool) {
+			_pool->_release(_idx);
+			_pool = nullptr;
+		}
+	}
+
+	inline uint8_t* FrameRef::data() const {
+		return _pool ? &_pool->_arena[size_t(_idx) * _pool->_slot_size] : nullptr;
+	}
+
+	inline uint16_t FrameRef::length() const {
+		return _pool ? _pool->_slots[_idx].len : 0;
+	}
+
+	inline uint32_t FrameRef::tick() const {
+		return _pool ? _pool->_slots[_idx].tick : 0;
+	}
+}
@@ -46,5 +46,20 @@ namespace TWE {
 
 			return (*this);
 		}
+
+		/**
+		 * @fn	inline IStreamOut& TWE_PutChar_Serial::write_bytes(const uint8_t* p, int len)
+		 *
+		 * @brief	Writes a byte sequence (e.g. a formatted command) with single write.
+		 *
+		 * @param	p  	the bytes.
+		 * @param	len	The length.
+		 *
+		 * @returns	this object.
+		 */
+		inline IStreamOut& write_bytes(const uint8_t* p, int len) {
+			if (len > 0) _ser.write(p, len);
+			return (*this);
+		}
 	};
 }
@@ -31,6 +31,10 @@ namespace TWE {
 		virtual ~IStreamOut() {}
 		virtual IStreamOut& operator ()(const char_t c) = 0; //! () operator as a function object
 		virtual IStreamOut& write_w(wchar_t c) { return *this; }
+		virtual IStreamOut& write_bytes(const uint8_t* p, int len) { //! write a byte sequence at once (default: one by one)
+			for (int i = 0; i < len; i++) operator ()((char_t)p[i]);
+			return *this;
+		}
 		inline IStreamOut& operator << (const char_t c) { return (*this)(c); } // should be on root class
 		inline IStreamOut& operator << (const uint8_t c) { return (*this)(c); } // should be on root class
 		inline IStreamOut& operator << (const wchar_t c) { return write_w(c); } // should be on root class
@@ -70,6 +74,7 @@ namespace TWE {
 		void reset(IStreamOut* ptr) { _sp.reset(ptr); }
 		IStreamOut& operator ()(char_t c) { return _sp->operator()(c); }
 		IStreamOut& write_w(wchar_t c) { return _sp->write_w(c); }
+		IStreamOut& write_bytes(const uint8_t* p, int len) { return _sp->write_bytes(p, len); }
 	};
 
 	/// <summary>
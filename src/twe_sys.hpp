@@ -28,6 +28,7 @@ extern uint32_t _u32TickCount_ms_on_boot;
 
 #if defined(__APPLE__) || defined(__linux)
 #include <sys/time.h>
+#include <time.h>
 #endif
 
 namespace TWESYS {
@@ -52,9 +53,10 @@ namespace TWESYS {
 #elif defined(_MSC_VER) || defined(__MINGW32__)
 		return (uint32_t)timeGetTime() - _u32TickCount_ms_on_boot;
 #elif defined(__APPLE__) || defined(__linux)
-		timeval time;
-		gettimeofday(&time, NULL);
-		long ms = (time.tv_sec * 1000) + (time.tv_usec / 1000);
+		// monotonic clock (not affected by the system time adjustment)
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		uint64_t ms = (uint64_t(time.tv_sec) * 1000) + (time.tv_nsec / 1000000);
 		return (uint32_t)ms - _u32TickCount_ms_on_boot;
 #else
 # error "no u32GetTick_ms() implementation."
@@ -95,6 +97,21 @@ namespace TWESYS {
 			start();
 		}
 
+		/**
+		 * @fn	inline void TimeOut::start_at(uint32_t now)
+		 *
+		 * @brief	Starts the timer with the given tick (e.g. arrival tick of received bytes),
+		 * 			without reading the clock.
+		 *
+		 * @param	now	the tick (u32GetTick_ms() based).
+		 */
+		inline void start_at(uint32_t now) {
+			if (_u16TimeOut > 0) {
+				_u16Start = (now & 0xFFFE);
+				_u16Start |= 0x0001; // set start flag
+			}
+		}
+
 		inline void stop() {
 			_u16Start &= 0xFFFE; // remove start flag
 		}
@@ -114,6 +131,28 @@ namespace TWESYS {
 			return uint16_t((u32GetTick_ms() & 0xFFFE) - (_u16Start & 0xFFFE));
 		}
 
+		/**
+		 * @fn	inline bool TimeOut::is_timeout_at(uint32_t now)
+		 *
+		 * @brief	Same as is_timeout(), but checks with the given tick.
+		 * 			The clock is not read unless the timer is started and now is 0.
+		 *
+		 * @param	now	the tick (u32GetTick_ms() based, 0: read the clock).
+		 *
+		 * @returns	True if timed out (the timer stops).
+		 */
+		inline bool is_timeout_at(uint32_t now) {
+			if (is_enabled()) {
+				if (now == 0) now = u32GetTick_ms();
+				bool b_timeout = (uint16_t((now & 0xFFFE) - (_u16Start & 0xFFFE)) > _u16TimeOut);
+				if (b_timeout) {
+					stop();
+					return true;
+				}
+			}
+			return false;
+		}
+
 		/**
 		 * @fn	inline bool TimeOut::is_enabled()
 		 *
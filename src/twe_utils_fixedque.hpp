@@ -4,6 +4,9 @@
  * Released under MW-OSSLA-1J,1E (MONO WIRELESS OPEN SOURCE SOFTWARE LICENSE AGREEMENT). */
 
 #include "twe_common.hpp"
+#include <cstring>
+#include <type_traits>
+#include <atomic>
 
 #if !defined(ESP32)
 # include "gen/sdl2_config.h"
@@ -228,6 +231,99 @@ namespace TWEUTILS {
 			}
 		}
 
+		/**
+		 * @fn	inline size_type FixedQueue::push(const T* p, size_type n)
+		 *
+		 * @brief	Pushes n items at once (single lock).
+		 * 			Items exceeding the free space are not stored.
+		 *
+		 * @param	p	source array.
+		 * @param	n	number of items.
+		 *
+		 * @returns	number of items stored.
+		 */
+		inline size_type push(const T* p, size_type n) {
+			if (!bMUTEX) return _push_n(p, n);
+			else {
+				auto l = TWE::LockGuard(_mtx);
+				return _push_n(p, n);
+			}
+		}
+
+		/**
+		 * @fn	inline size_type FixedQueue::push_force(const T* p, size_type n)
+		 *
+		 * @brief	Pushes n items at once (single lock).
+		 * 			If the queue overflows, older entries are removed.
+		 *
+		 * @param	p	source array.
+		 * @param	n	number of items.
+		 *
+		 * @returns	number of older entries dropped to make a room.
+		 */
+		inline size_type push_force(const T* p, size_type n) {
+			if (!bMUTEX) return _push_force_n(p, n);
+			else {
+				auto l = TWE::LockGuard(_mtx);
+				return _push_force_n(p, n);
+			}
+		}
+
+		/**
+		 * @fn	inline size_type FixedQueue::pop_front(T* p, size_type n)
+		 *
+		 * @brief	Pops up to n items at once (single lock).
+		 *
+		 * @param [out]	p	destination array.
+		 * @param 		n	max number of items to pop.
+		 *
+		 * @returns	number of items popped.
+		 */
+		inline size_type pop_front(T* p, size_type n) {
+			if (!bMUTEX) return _pop_n(p, n);
+			else {
+				auto l = TWE::LockGuard(_mtx);
+				return _pop_n(p, n);
+			}
+		}
+
+		/**
+		 * @fn	inline size_type FixedQueue::free_spans(T*& p1, size_type& n1, T*& p2, size_type& n2)
+		 *
+		 * @brief	Gets the free region as two contiguous spans (p2 is for the wrap-around part).
+		 * 			The caller (the only producer) writes items there directly,
+		 * 			then call commit_push() to store them.
+		 *
+		 * @param [out]	p1	the first span.
+		 * @param [out]	n1	length of p1.
+		 * @param [out]	p2	the second span.
+		 * @param [out]	n2	length of p2.
+		 *
+		 * @returns	total length of the free region.
+		 */
+		inline size_type free_spans(T*& p1, size_type& n1, T*& p2, size_type& n2) {
+			if (!bMUTEX) return _free_spans(p1, n1, p2, n2);
+			else {
+				auto l = TWE::LockGuard(_mtx);
+				return _free_spans(p1, n1, p2, n2);
+			}
+		}
+
+		/**
+		 * @fn	inline void FixedQueue::commit_push(size_type n)
+		 *
+		 * @brief	Stores n items written into the spans given by free_spans().
+		 *
+		 * @param	n	number of items.
+		 */
+		inline void commit_push(size_type n) {
+			if (!bMUTEX) _commit_push(n);
+			else {
+				auto l = TWE::LockGuard(_mtx);
+				_commit_push(n);
+			}
+		}
+
 	private:
 		inline void _init() {
 #if MWM5_SDL2_USE_MULTITHREAD_RENDER == 1 && MWM5_USE_SDL2_MUTEX == 1
@@ -252,7 +348,7 @@ namespace TWEUTILS {
 
 		inline void _pop() {
 			if (_ct > 0) {
-				_p[_tail] = T{};
+				if (!std::is_trivially_copyable<T>::value) _p[_tail] = T{};
 				_tail++;
 
 				if (_tail >= _size) {
@@ -309,6 +405,72 @@ namespace TWEUTILS {
 			return r;
 		}
 
+		inline size_type _push_n(const T* p, size_type n) {
+			size_type n_free = _size - _ct;
+			if (n > n_free) n = n_free;
+
+			for (size_type i = 0; i < n; i++) {
+				_p[_head++] = p[i];
+				if (_head >= _size) _head = 0;
+			}
+			_ct += n;
+
+			return n;
+		}
+
+		inline size_type _push_force_n(const T* p, size_type n) {
+			size_type n_drop = 0;
+
+			if (_size == 0) return 0;
+			if (n > _size) { // only the last _size entries remain.
+				n_drop = _ct + (n - _size);
+				p += n - _size;
+				n = _size;
+				_clear();
+			}
+			else if (n > _size - _ct) {
+				n_drop = n - (_size - _ct);
+				for (size_type i = 0; i < n_drop; i++) _pop();
+			}
+
+			_push_n(p, n);
+			return n_drop;
+		}
+
+		inline size_type _pop_n(T* p, size_type n) {
+			if (n > _ct) n = _ct;
+
+			for (size_type i = 0; i < n; i++) {
+				p[i] = std::move(_p[_tail]);
+				if (!std::is_trivially_copyable<T>::value) _p[_tail] = T{};
+				_tail++;
+				if (_tail >= _size) _tail = 0;
+			}
+			_ct -= n;
+
+			return n;
+		}
+
+		inline size_type _free_spans(T*& p1, size_type& n1, T*& p2, size_type& n2) {
+			size_type n_free = _size - _ct;
+
+			p1 = _size ? &_p[_head] : nullptr;
+			n1 = (n_free < _size - _head) ? n_free : _size - _head;
+			p2 = _size ? &_p[0] : nullptr;
+			n2 = n_free - n1;
+
+			return n_free;
+		}
+
+		inline void _commit_push(size_type n) {
+			if (n > _size - _ct) n = _size - _ct;
+
+			uint32_t h = uint32_t(_head) + n;
+			if (h >= _size) h -= _size;
+			_head = size_type(h);
+			_ct += n;
+		}
+
 		inline T& _at(int i) {
 			int idx;
 			if (i >= 0) { // positive index (0,..,size()-1), get from older ones
@@ -326,20 +488,294 @@ namespace TWEUTILS {
 
 	};
 
-	template <typename T, bool bMUTEX=false>
+	/**
+	 * @class	SpscQueue
+	 *
+	 * @brief	Wait-free ring buffer for single producer / single consumer.
+	 * 			The capacity is rounded up to power of two, indices are masked.
+	 * 			- push*() must be called from one thread (producer).
+	 * 			- pop*(), front(), clear() must be called from one thread (consumer).
+	 * 			- On overrun, newer entries are discarded (the producer never touches the tail).
+	 */
+	template <typename T>
+	class SpscQueue {
+	public:
+		typedef uint32_t size_type;
+		typedef T value_type;
+
+	private:
+		std::unique_ptr<T[]> _p;
+		size_type _size;
+		size_type _mask;
+		alignas(64) std::atomic<size_type> _head; // written by producer
+		alignas(64) std::atomic<size_type> _tail; // written by consumer
+
+		static size_type _round_pow2(size_type n) {
+			size_type r = 1;
+			while (r < n) r <<= 1;
+			return r;
+		}
+
+	public:
+		SpscQueue() : _p(), _size(0), _mask(0), _head(0), _tail(0) {}
+
+		SpscQueue(size_type n) : _p(), _size(_round_pow2(n)), _mask(_size - 1), _head(0), _tail(0) {
+			_p.reset(new T[_size]);
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+
+		inline size_type capacity() const { return _size; }
+
+		inline size_type size() const {
+			return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+		}
+
+		inline bool empty() const { return size() == 0; }
+
+		inline bool is_full() const { return size() >= _size; }
+
+		// consumer side
+		inline void clear() {
+			_tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+		}
+
+		// producer side
+		inline void push(const T& c) {
+			size_type h = _head.load(std::memory_order_relaxed);
+			if (h - _tail.load(std::memory_order_acquire) < _size) {
+				_p[h & _mask] = c;
+				_head.store(h + 1, std::memory_order_release);
+			}
+		}
+
+		// producer side
+		inline size_type push(const T* p, size_type n) {
+			size_type h = _head.load(std::memory_order_relaxed);
+			size_type n_free = _size - (h - _tail.load(std::memory_order_acquire));
+			if (n > n_free) n = n_free;
+
+			size_type i0 = h & _mask;
+			size_type n1 = (n < _size - i0) ? n : _size - i0;
+			_copy(&_p[i0], p, n1);
+			_copy(&_p[0], p + n1, n - n1);
+
+			_head.store(h + n, std::memory_order_release);
+			return n;
+		}
+
+		/**
+		 * @fn	inline size_type SpscQueue::push_drop_new(const T* p, size_type n)
+		 *
+		 * @brief	same as push(), but returns the number of entries discarded.
+		 * 			(unlike FixedQueue::push_force(), the producer cannot remove older entries,
+		 * 			 the newer ones are discarded.)
+		 */
+		inline size_type push_drop_new(const T* p, size_type n) {
+			return n - push(p, n);
+		}
+
+		// consumer side
+		inline T& front() {
+			return _p[_tail.load(std::memory_order_relaxed) & _mask];
+		}
+
+		// consumer side
+		inline void pop() {
+			size_type t = _tail.load(std::memory_order_relaxed);
+			if (_head.load(std::memory_order_acquire) != t) {
+				_tail.store(t + 1, std::memory_order_release);
+			}
+		}
+
+		// consumer side
+		inline size_type pop_front(T* p, size_type n) {
+			size_type t = _tail.load(std::memory_order_relaxed);
+			size_type n_used = _head.load(std::memory_order_acquire) - t;
+			if (n > n_used) n = n_used;
+
+			size_type i0 = t & _mask;
+			size_type n1 = (n < _size - i0) ? n : _size - i0;
+			_copy(p, &_p[i0], n1);
+			_copy(p + n1, &_p[0], n - n1);
+
+			_tail.store(t + n, std::memory_order_release);
+			return n;
+		}
+
+	private:
+		static inline void _copy(T* dst, const T* src, size_type n) {
+			if (n == 0) return;
+			if (std::is_trivially_copyable<T>::value) {
+				memcpy((void*)dst, (const void*)src, n * sizeof(T));
+			}
+			else {
+				for (size_type i = 0; i < n; i++) dst[i] = src[i];
+			}
+		}
+	};
+
+	// a mark of arrival tick (see TickMarks)
+	struct TickMark {
+		uint32_t pos_end; // count of pushed items at the end of the range.
+		uint32_t tick;    // arrival tick of the range.
+	};
+
+	/**
+	 * @class	TickMarks
+	 *
+	 * @brief	Arrival ticks of byte (item) ranges stored in a queue.
+	 * 			Each mark holds the free running count of pushed items at the end of
+	 * 			the range and its tick. The consumer limits a read to one range,
+	 * 			then all items read at once share the same arrival tick.
+	 * 			MQUE is the queue type of marks (FixedQueue or SpscQueue), which
+	 * 			should follow the thread model of the data queue.
+	 *
+	 * 			If the mark queue is full (the consumer is behind), the producer holds
+	 * 			the newest mark and merges the following ranges into it, so they keep
+	 * 			the earlier tick instead of the tick of a later range.
+	 */
+	template <class MQUE>
+	class TickMarks {
+	public:
+		typedef TickMark mark;
+
+	private:
+		MQUE _q;
+		uint32_t _pos_push; // producer side counter
+		uint32_t _pos_pop;  // consumer side counter
+		std::atomic<uint32_t> _n_skip; // items removed without reading (e.g. oldest entries dropped)
+		uint32_t _tick_last; // the tick of the last range (consumer side)
+		mark _m_hold;        // the newest mark not queued yet (producer side, the queue was full)
+		bool _b_hold;
+
+	public:
+		TickMarks(typename MQUE::size_type n = 64) : _q(n), _pos_push(0), _pos_pop(0), _n_skip(0), _tick_last(0), _m_hold(), _b_hold(false) {}
+
+		// producer: n items are stored with tick. (tick==0: unknown, counted only)
+		// returns false if the mark queue is full and the range is merged into the newest mark.
+		inline bool on_push(uint32_t n, uint32_t tick) {
+			if (n == 0) return true;
+			_pos_push += n;
+
+			if (_b_hold && _q.push(&_m_hold, 1) == 1) _b_hold = false; // the queue has room again.
+			if (tick == 0) return true;
+
+			if (_b_hold) {
+				_m_hold.pos_end = _pos_push; // merged (keeps the earlier tick)
+				return false;
+			}
+
+			mark m{ _pos_push, tick };
+			if (_q.push(&m, 1) != 1) {
+				_m_hold = m; // queued later, till then the items are read with the tick before.
+				_b_hold = true;
+				return false;
+			}
+			return true;
+		}
+
+		// n items are removed from the queue without reading.
+		inline void on_skip(uint32_t n) {
+			_n_skip += n;
+		}
+
+		// consumer: limit n to the current range and returns its tick (0: unknown).
+		inline uint32_t limit(uint32_t& n) {
+			_pos_pop += _n_skip.exchange(0);
+
+			while (!_q.empty()) {
+				mark m = _q.front();
+				int32_t rest = int32_t(m.pos_end - _pos_pop);
+				if (rest <= 0) {
+					_tick_last = m.tick;
+					_q.pop();
+					continue;
+				}
+				if (n > uint32_t(rest)) n = uint32_t(rest);
+				return m.tick;
+			}
+
+			return _tick_last;
+		}
+
+		// consumer: n items are read.
+		inline void on_pop(uint32_t n) {
+			_pos_pop += n;
+		}
+
+		// consumer: discards all marks.
+		inline void clear() {
+			_q.clear();
+			_pos_pop = _pos_push;
+			_n_skip = 0;
+		}
+	};
+
+	/**
+	 * @class	InputQueue
+	 *
+	 * @brief	Input queue. QUE is the backing store type, 
+	 * 			FixedQueue<T, bMUTEX> (default) or SpscQueue<T>.
+	 */
+	template <typename T, bool bMUTEX=false, class QUE=TWEUTILS::FixedQueue<T, bMUTEX>>
 	class InputQueue {
+		template <class Q, typename M> struct _mark_que { typedef FixedQueue<M, bMUTEX> type; };
+		template <typename X, typename M> struct _mark_que<SpscQueue<X>, M> { typedef SpscQueue<M> type; };
+
+		// push into the backing store, returns the number of entries dropped.
+		template <typename X, bool M>
+		static inline typename FixedQueue<X, M>::size_type _push_que(FixedQueue<X, M>& q, const T* p, typename FixedQueue<X, M>::size_type n) {
+			return q.push_force(p, n); // older ones are removed.
+		}
+		template <typename X>
+		static inline typename SpscQueue<X>::size_type _push_que(SpscQueue<X>& q, const T* p, typename SpscQueue<X>::size_type n) {
+			return q.push_drop_new(p, n); // newer ones are discarded.
+		}
+
+	public:
+		/**
+		 * @struct	stats
+		 *
+		 * @brief	counters of the producer side (see get_stats()).
+		 */
+		struct stats {
+			uint32_t u32pushed;     // items passed to push()
+			uint32_t u32dropped;    // items lost by overrun
+			uint32_t u32high_water; // max number of items in the queue
+			uint32_t u32capacity;   // size of the queue
+			uint32_t u32tick_merged; // ranges merged into the previous arrival tick (the mark queue was full)
+		};
+
+		typedef QUE queue_type;
+		typedef typename QUE::size_type size_type;
+		typedef TickMarks<typename _mark_que<QUE, TickMark>::type> marks_type;
+
 	protected:
-		std::unique_ptr<TWEUTILS::FixedQueue<T, bMUTEX>> _cue;
+		std::unique_ptr<QUE> _cue;
+		std::unique_ptr<marks_type> _marks; // arrival ticks
+
+		// counters (updated by the producer)
+		std::atomic<uint32_t> _u32pushed;
+		std::atomic<uint32_t> _u32dropped;
+		std::atomic<uint32_t> _u32hwm;
+		std::atomic<uint32_t> _u32tick_merged;
+
+		// size of the mark queue (a mark per 16 items, 64 at least)
+		static inline size_type _marks_size(size_type n) {
+			return n / 16 > 64 ? size_type(n / 16) : size_type(64);
+		}
 		
 	public:
-		InputQueue() : _cue() {}
+		InputQueue() : _cue(), _marks(), _u32pushed(0), _u32dropped(0), _u32hwm(0), _u32tick_merged(0) {}
 
-		InputQueue(typename TWEUTILS::FixedQueue<T, bMUTEX>::size_type n) : _cue() {
+		InputQueue(size_type n) : _cue(), _marks(), _u32pushed(0), _u32dropped(0), _u32hwm(0), _u32tick_merged(0) {
 			setup(n);
 		}
 
-		void setup(typename TWEUTILS::FixedQueue<T, bMUTEX>::size_type size) {
-			_cue.reset(new TWEUTILS::FixedQueue<T, bMUTEX>(size));
+		void setup(size_type size) {
+			_cue.reset(new QUE(size));
+			_marks.reset(new marks_type(_marks_size(size)));
 		}
 
 		inline int pop_front() {
@@ -350,15 +786,56 @@ namespace TWEUTILS {
 			if (!_cue->empty()) {
 				ret = _cue->front();
 				_cue->pop();
+				_marks->on_pop(1);
 			}
 
 			return ret;
 		}
 
 		inline void push(T c) {
-			if (_cue) {
-				if (is_full()) _cue->pop(); // incase buffer is overrun, remove oldest entry.
-				_cue->push(c);
+			push(&c, 1, 0);
+		}
+
+		/**
+		 * @fn	inline void InputQueue::push(const T* p, int len)
+		 *
+		 * @brief	Pushes len items at once, the queue is locked once.
+		 * 			In case buffer is overrun, oldest entries are removed.
+		 * 			(SpscQueue discards newer ones instead.)
+		 *
+		 * @param	p  	source array.
+		 * @param	len	number of items.
+		 */
+		inline void push(const T* p, int len) {
+			push(p, len, 0);
+		}
+
+		/**
+		 * @fn	inline void InputQueue::push(const T* p, int len, uint32_t tick)
+		 *
+		 * @brief	Pushes len items at once with the arrival tick of them.
+		 *
+		 * @param	p   	source array.
+		 * @param	len 	number of items.
+		 * @param	tick	arrival tick (0: unknown).
+		 */
+		inline void push(const T* p, int len, uint32_t tick) {
+			if (_cue && len > 0) {
+				size_type n_drop = _push_que(*_cue, p, size_type(len));
+				bool b_mark;
+				if (std::is_same<QUE, SpscQueue<T>>::value) {
+					b_mark = _marks->on_push(uint32_t(len) - n_drop, tick); // newer ones are discarded.
+				}
+				else {
+					b_mark = _marks->on_push(uint32_t(len), tick);
+					if (n_drop) _marks->on_skip(n_drop); // older ones are removed.
+				}
+				if (!b_mark) _u32tick_merged.fetch_add(1, std::memory_order_relaxed);
+
+				_u32pushed.fetch_add(uint32_t(len), std::memory_order_relaxed);
+				if (n_drop) _u32dropped.fetch_add(uint32_t(n_drop), std::memory_order_relaxed);
+				uint32_t n = uint32_t(_cue->size());
+				if (n > _u32hwm.load(std::memory_order_relaxed)) _u32hwm.store(n, std::memory_order_relaxed);
 			}
 		}
 
@@ -373,6 +850,35 @@ namespace TWEUTILS {
 			return _cue ? _cue->is_full() : true;
 		}
 
+		/**
+		 * @fn	inline stats InputQueue::get_stats()
+		 *
+		 * @brief	Gets the counters (pushed/dropped items and high water mark).
+		 *
+		 * @returns	The counters.
+		 */
+		inline stats get_stats() {
+			stats s;
+			s.u32pushed = _u32pushed.load(std::memory_order_relaxed);
+			s.u32dropped = _u32dropped.load(std::memory_order_relaxed);
+			s.u32high_water = _u32hwm.load(std::memory_order_relaxed);
+			s.u32capacity = _cue ? uint32_t(_cue->capacity()) : 0;
+			s.u32tick_merged = _u32tick_merged.load(std::memory_order_relaxed);
+			return s;
+		}
+
+		/**
+		 * @fn	inline void InputQueue::reset_stats()
+		 *
+		 * @brief	Resets the counters.
+		 */
+		inline void reset_stats() {
+			_u32pushed.store(0, std::memory_order_relaxed);
+			_u32dropped.store(0, std::memory_order_relaxed);
+			_u32hwm.store(0, std::memory_order_relaxed);
+			_u32tick_merged.store(0, std::memory_order_relaxed);
+		}
+
 	public:
 
 		/**
@@ -397,6 +903,44 @@ namespace TWEUTILS {
 			return pop_front();
 		}
 
+		/**
+		 * @fn	inline int InputQueue::read(T* p, int len)
+		 *
+		 * @brief	Read up to len items from queue, the queue is locked once.
+		 *
+		 * @param [out]	p  	destination array.
+		 * @param 		len	max number of items.
+		 *
+		 * @returns	number of items read. (0: empty)
+		 */
+		inline int read(T* p, int len) {
+			uint32_t tick;
+			return read(p, len, tick);
+		}
+
+		/**
+		 * @fn	inline int InputQueue::read(T* p, int len, uint32_t& tick)
+		 *
+		 * @brief	Read up to len items which arrived at once (see push(p, len, tick)).
+		 *
+		 * @param [out]	p   	destination array.
+		 * @param 		len 	max number of items.
+		 * @param [out]	tick	arrival tick of the items (0: unknown).
+		 *
+		 * @returns	number of items read. (0: empty)
+		 */
+		inline int read(T* p, int len, uint32_t& tick) {
+			tick = 0;
+			if (!_cue || len <= 0) return 0;
+
+			uint32_t n = uint32_t(len);
+			tick = _marks->limit(n);
+
+			n = _cue->pop_front(p, size_type(n));
+			_marks->on_pop(n);
+			return int(n);
+		}
+
 		/**
 		 * @fn	inline int InputQueue::peek()
 		 *
@@ -32,6 +32,10 @@ namespace TWEUTILS {
 	public:
 		_SimpleBuffer_Dynamic() : _ptr(nullptr) {}
 		_SimpleBuffer_Dynamic(size_t n) : _ptr(new T[n]) {}
+		~_SimpleBuffer_Dynamic() { delete[] _ptr; }
+
+		_SimpleBuffer_Dynamic(const _SimpleBuffer_Dynamic&) = delete;
+		_SimpleBuffer_Dynamic& operator = (const _SimpleBuffer_Dynamic&) = delete;
 
 		T* get_pt() { return _ptr; }
 	};
@@ -178,19 +182,74 @@ namespace TWEUTILS {
 			pointer ptr_;
 		};
 
+		// growth of push_back() (see set_growth_step())
+		static const size_type GROW_MIN = 64; // the first allocation
+#if defined(ESP32)
+		static const size_type GROW_STEP_DEFAULT = 64; // fixed steps as before, memory is tight on M5Stack
+#else
+		static const size_type GROW_STEP_DEFAULT = 0; // geometric
+#endif
+
 	private:
 		T* _p;
 
 		size_type _u16len;
-		size_type _u16maxlen;;
+		size_type _u16maxlen;
+		size_type _u16grow; // 0: geometric (x1.5), otherwise: the elements added at once
 
 		std::unique_ptr<_SimpleBuffer_Dynamic<T>> _sp;
 
+		// move elements into the new buffer (memcpy if trivially copyable)
+		static inline void _relocate(T* dst, T* src, size_type n, std::true_type) {
+			std::memcpy((void*)dst, (const void*)src, sizeof(T) * n);
+		}
+		static inline void _relocate(T* dst, T* src, size_type n, std::false_type) {
+			for (size_type i = 0; i < n; i++) {
+				dst[i] = std::move(src[i]);
+			}
+		}
+		static inline void _relocate(T* dst, T* src, size_type n) {
+			_relocate(dst, src, n, typename std::is_trivially_copyable<T>::type());
+		}
+
+		// copy elements (memcpy if trivially copyable)
+		static inline void _copy(T* dst, const T* src, size_type n) {
+			if (std::is_trivially_copyable<T>::value) {
+				std::memcpy((void*)dst, (const void*)src, sizeof(T) * n);
+			}
+			else {
+				for (size_type i = 0; i < n; i++) {
+					dst[i] = src[i];
+				}
+			}
+		}
+
+		// allocate a new buffer of maxlen and move the elements
+		void _realloc(size_type maxlen) {
+			std::unique_ptr<_SimpleBuffer_Dynamic<T>> buff(new _SimpleBuffer_Dynamic<T>(size_type(maxlen + is_string_type)));
+			_u16maxlen = maxlen;
+
+			if (_u16len && _p) {
+				_relocate(buff->get_pt(), _p, _u16len);
+			}
+
+			_sp = std::move(buff);
+			_p = _sp->get_pt();
+		}
+
+		// expand the buffer by the growth policy to have `req' elements at least.
+		void _grow(size_type req) {
+			size_type n = _u16grow ? _u16maxlen + _u16grow : _u16maxlen + (_u16maxlen >> 1);
+			if (n < GROW_MIN) n = GROW_MIN;
+			if (n < req) n = req;
+			reserve(n);
+		}
+
 	public:
 		/// <summary>
 		/// コンストラクタ
 		/// </summary>
-		SimpleBuffer() : _p(nullptr), _u16len(0), _u16maxlen(0), _sp() {}
+		SimpleBuffer() : _p(nullptr), _u16len(0), _u16maxlen(0), _u16grow(GROW_STEP_DEFAULT), _sp() {}
 
 		/// <summary>
 		/// コンストラクタ、パラメータ全部渡し
@@ -198,7 +257,7 @@ namespace TWEUTILS {
 		/// <param name="p"></param>
 		/// <param name="u16len"></param>
 		/// <param name="u16maxlen"></param>
-		SimpleBuffer(T* p, size_type u16len, size_type u16maxlen) : _p(p), _u16len(u16len), _u16maxlen(u16maxlen), _sp() {}
+		SimpleBuffer(T* p, size_type u16len, size_type u16maxlen) : _p(p), _u16len(u16len), _u16maxlen(u16maxlen), _u16grow(GROW_STEP_DEFAULT), _sp() {}
 
 		/**
 		 * @fn	SimpleBuffer::SimpleBuffer(uint16_t u16maxlen)
@@ -207,7 +266,7 @@ namespace TWEUTILS {
 		 *
 		 * @param	u16maxlen	The maximum buffer length
 		 */
-		SimpleBuffer(size_type u16maxlen) : _u16len(0), _u16maxlen(u16maxlen), _sp(new _SimpleBuffer_Dynamic<T>(u16maxlen + is_string_type)) {
+		SimpleBuffer(size_type u16maxlen) : _u16len(0), _u16maxlen(u16maxlen), _u16grow(GROW_STEP_DEFAULT), _sp(new _SimpleBuffer_Dynamic<T>(u16maxlen + is_string_type)) {
 			_p = _sp->get_pt();
 		}
 
@@ -243,7 +302,7 @@ namespace TWEUTILS {
 		 *
 		 * @param	ref	.
 		 */
-		SimpleBuffer(SimpleBuffer&& ref) noexcept
+		SimpleBuffer(SimpleBuffer&& ref) noexcept : _p(nullptr), _u16len(0), _u16maxlen(0), _u16grow(ref._u16grow), _sp()
 		{
 			operator=(std::forward<SimpleBuffer>(ref));
 		}
@@ -253,9 +312,7 @@ namespace TWEUTILS {
 				reserve_and_set_empty(ref._u16len); // if assigned, reserve minimum memory here.
 
 				// copy buffer
-				for (size_type i = 0; i < ref._u16len; i++) {
-					_p[i] = ref._p[i];
-				}
+				_copy(_p, ref._p, ref._u16len);
 
 				// create new buffer and copy
 				_u16len = ref._u16len;
@@ -277,7 +334,7 @@ namespace TWEUTILS {
 		 *
 		 */
 		template <signed N>
-		SimpleBuffer(const T(&ref)[N]) : _p(nullptr), _u16len(0), _u16maxlen(0), _sp() {
+		SimpleBuffer(const T(&ref)[N]) : _p(nullptr), _u16len(0), _u16maxlen(0), _u16grow(GROW_STEP_DEFAULT), _sp() {
 			operator=(ref);
 		}
 
@@ -300,7 +357,7 @@ namespace TWEUTILS {
 				>::value // is_same
 			>::type // enable_if
 		>
-		SimpleBuffer(T_ p_ref) : _p(nullptr), _u16len(0), _u16maxlen(0), _sp()
+		SimpleBuffer(T_ p_ref) : _p(nullptr), _u16len(0), _u16maxlen(0), _u16grow(GROW_STEP_DEFAULT), _sp()
 		{
 			operator=(p_ref);
 		}
@@ -415,24 +472,40 @@ namespace TWEUTILS {
 			if (_p && !_sp) {
 				// attaching existing memory region, no change.
 			} else {
-				std::unique_ptr<_SimpleBuffer_Dynamic<T>> buff(new _SimpleBuffer_Dynamic<T>(size_type(maxlen+is_string_type)));
-				_u16maxlen = maxlen;
-
-				if (_u16len) {
-					auto _p_new = buff->get_pt();
-					
-					if (_p) {
-						for (size_type i = 0; i < _u16len; i++) {
-							_p_new[i] = std::move(_p[i]);
-						}
-					}
-				}
+				_realloc(maxlen);
+			}
+		}
 
-				_sp = std::move(buff);
-				_p = _sp->get_pt();
+		/**
+		 * @fn	void SimpleBuffer::shrink_to_fit()
+		 *
+		 * @brief	Reduces the allocated buffer to the current length
+		 * 			(no change for the attached memory region).
+		 */
+		void shrink_to_fit() {
+			if (!_sp || _u16maxlen <= _u16len) return;
+
+			if (_u16len == 0 && !is_string_type) {
+				_sp.reset();
+				_p = nullptr;
+				_u16maxlen = 0;
+			}
+			else {
+				_realloc(_u16len);
 			}
 		}
 
+		/**
+		 * @fn	void SimpleBuffer::set_growth_step(size_type n)
+		 *
+		 * @brief	Sets the growth policy of push_back() on a full buffer.
+		 * 			0 expands the capacity by x1.5 (amortized O(1)),
+		 * 			otherwise by n elements (less memory, the default on ESP32/M5Stack).
+		 *
+		 * @param	n	elements added at once, 0: geometric.
+		 */
+		inline void set_growth_step(size_type n) { _u16grow = n; }
+
 		void reserve_and_set_empty(size_type maxlen) {
 			reserve(maxlen);
 			resize(0);
@@ -548,15 +621,41 @@ namespace TWEUTILS {
 			}
 		}
 		
-		inline void push_back(T&& c) { 
-			if (_u16len >= _u16maxlen) reserve(_u16maxlen == 0 ? 64 : _u16maxlen + 64);
-			_p[_u16len++] = std::forward<T>(c);
+		/**
+		 * @fn	inline bool SimpleBuffer::push_back(T&& c)
+		 *
+		 * @brief	Appends an element, the buffer is expanded if full (see set_growth_step()).
+		 * 			The elements are allocated by new T[], so c is assigned to the existing one.
+		 *
+		 * @returns	True if it succeeds, false if the attached memory region is full.
+		 */
+		inline bool push_back(T&& c) { 
+			if (_u16len >= _u16maxlen) _grow(_u16len + 1);
+			return append(std::forward<T>(c));
+		}
+
+		inline bool push_back(const T& c) {
+			if (_u16len >= _u16maxlen) _grow(_u16len + 1);
+			return append(c);
 		}
 
-		inline void push_back(const T& c) {
-			if (!append(c)) {
-				reserve(_u16maxlen == 0 ? 64 : _u16maxlen + 64);
-				append((c));
+		/**
+		 * @fn	template <class... A> inline bool SimpleBuffer::emplace_back(A&&... a)
+		 *
+		 * @brief	Appends an element made of the arguments, the buffer is expanded if full
+		 * 			(same as push_back()). The new element is move-assigned to the existing one.
+		 *
+		 * @returns	True if it succeeds, false if the attached memory region is full.
+		 */
+		template <class... A>
+		inline bool emplace_back(A&&... a) {
+			if (_u16len >= _u16maxlen) _grow(_u16len + 1);
+			if (_u16len < _u16maxlen) {
+				_p[_u16len++] = T(std::forward<A>(a)...);
+				return true;
+			}
+			else {
+				return false;
 			}
 		}
 
@@ -856,11 +955,11 @@ namespace TWEUTILS {
 
 	// some operators << to the IStreamOut.
 	inline TWE::IStreamOut& operator << (TWE::IStreamOut& lhs, const SmplBuf_Byte& s) {
-		for (const auto x : s) { lhs.operator ()((const char_t)x); }
+		lhs.write_bytes(s.data(), int(s.length()));
 		return lhs;
 	}
 	inline TWE::IStreamOut& operator << (TWE::IStreamOut& lhs, const SmplBuf_ByteS& s) {
-		for (const auto x : s) { lhs.operator ()((const char_t)x); }
+		lhs.write_bytes(s.data(), int(s.length()));
 		return lhs;
 	}
 	template <int N>
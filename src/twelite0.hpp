@@ -12,6 +12,7 @@
 #include "twe_sercmd.hpp"
 #include "twe_sercmd_ascii.hpp"
 #include "twe_sercmd_binary.hpp"
+#include "twe_sercmd_auto.hpp"
 #include "twe_console.hpp"
 #include "twe_printf.hpp"
 #include "twe_fmt.hpp"